@@ -17,6 +17,8 @@
  */
 #include "ClientService.h"
 #include "ServiceWorker.h"
+#include "PushEventQueue.h"
+#include "DeviceInfoCache.h"
 #include "pwtShared/Utils.h"
 
 namespace PWTCS {
@@ -24,10 +26,14 @@ namespace PWTCS {
         serviceThread->quit();
         serviceThread->wait();
         delete serviceThread;
+        delete pushEvents;
+        delete deviceInfoCache;
     }
 
     ClientService::ClientService() {
-        service = new ServiceWorker();
+        pushEvents = new PushEventQueue();
+        deviceInfoCache = new DeviceInfoCache();
+        service = new ServiceWorker(pushEvents);
         serviceThread = new QThread();
 
         service->moveToThread(serviceThread);
@@ -48,13 +54,20 @@ namespace PWTCS {
         QObject::connect(service, &ServiceWorker::profileApplied, this, &ClientService::onProfileApplied);
         QObject::connect(service, &ServiceWorker::daemonSettingsReceived, this, &ClientService::onDaemonSettingsReceived);
         QObject::connect(service, &ServiceWorker::daemonSettingsApplied, this, &ClientService::onDaemonSettingsApplied);
-        QObject::connect(service, &ServiceWorker::batteryStatusChanged, this, &ClientService::onBatteryStatusChanged);
-        QObject::connect(service, &ServiceWorker::wakeFromSleepEvent, this, &ClientService::onWakeFromSleepEvent);
-        QObject::connect(service, &ServiceWorker::applyTimerTick, this, &ClientService::onApplyTimerTick);
+        QObject::connect(service, &ServiceWorker::prefetchCompleted, this, &ClientService::onPrefetchCompleted);
+        QObject::connect(service, &ServiceWorker::commandLatency, this, &ClientService::onCommandLatency);
+        QObject::connect(service, &ServiceWorker::daemonHealthChanged, this, &ClientService::onDaemonHealthChanged);
+        QObject::connect(service, &ServiceWorker::pushEventsQueued, this, &ClientService::onPushEventsQueued);
         QObject::connect(service, &ServiceWorker::profilesExported, this, &ClientService::onProfilesExported);
         QObject::connect(service, &ServiceWorker::profilesImported, this, &ClientService::onProfilesImported);
         QObject::connect(this, &ClientService::workerDisconnectFromDaemon, service, &ServiceWorker::disconnectFromDaemon);
         QObject::connect(this, &ClientService::workerConnectToDaemon, service, &ServiceWorker::connectToDaemon);
+        QObject::connect(this, &ClientService::workerSetReadBufferSize, service, &ServiceWorker::setReadBufferSize);
+        QObject::connect(this, &ClientService::workerSetMaxFrameSize, service, &ServiceWorker::setMaxFrameSize);
+        QObject::connect(this, &ClientService::workerSetPrefetchCommands, service, &ServiceWorker::setPrefetchCommands);
+        QObject::connect(this, &ClientService::workerStartCapture, service, &ServiceWorker::startCapture);
+        QObject::connect(this, &ClientService::workerStopCapture, service, &ServiceWorker::stopCapture);
+        QObject::connect(this, &ClientService::workerSetBulkLaneEnabled, service, &ServiceWorker::setBulkLaneEnabled);
         QObject::connect(this, &ClientService::workerSendGetDeviceInfoPacketRequest, service, &ServiceWorker::sendGetDeviceInfoPacketRequest);
         QObject::connect(this, &ClientService::workerSendGetDaemonPacketRequest, service, &ServiceWorker::sendGetDaemonPacketRequest);
         QObject::connect(this, &ClientService::workerSendApplySettingsRequest, service, &ServiceWorker::sendApplySettingsRequest);
@@ -67,26 +80,146 @@ namespace PWTCS {
         QObject::connect(this, &ClientService::workerSendApplyProfileRequest, service, &ServiceWorker::sendApplyProfileRequest);
         QObject::connect(this, &ClientService::workerSendExportProfilesRequest, service, &ServiceWorker::sendExportProfilesRequest);
         QObject::connect(this, &ClientService::workerSendImportProfilesRequest, service, &ServiceWorker::sendImportProfilesRequest);
+        QObject::connect(this, &ClientService::workerSendSyncProfilesRequest, service, &ServiceWorker::sendSyncProfilesRequest);
+        QObject::connect(this, &ClientService::workerClearProfileSyncState, service, &ServiceWorker::clearProfileSyncState);
 
         serviceThread->start();
     }
 
     void ClientService::connectToDaemon(const QString &adr, const quint16 port) {
+        cache.clear();
+        deviceInfoHash.clear();
+        deviceInfoValidationPending = false;
+        startupLatencyMs = -1;
+        healthScore = 1;
+
+        if (deviceInfoCacheEnabled)
+            loadCachedDeviceInfo(adr, port);
+
         emit workerConnectToDaemon(adr, port);
     }
 
+    void ClientService::setReadBufferSize(const qint64 size) {
+        emit workerSetReadBufferSize(size);
+    }
+
+    void ClientService::setMaxFrameSize(const qint64 size) {
+        emit workerSetMaxFrameSize(size);
+    }
+
+    void ClientService::setPrefetchCommands(const QList<PWTS::DCMD> &cmds) {
+        prefetchCmds = cmds;
+        emit workerSetPrefetchCommands(cmds);
+    }
+
+    void ClientService::setMaxPendingPushEvents(const int max) {
+        pushEvents->setMaxPending(max);
+    }
+
+    int ClientService::getMaxPendingPushEvents() const {
+        return pushEvents->getMaxPending();
+    }
+
+    quint64 ClientService::getDroppedPushEventsCount() const {
+        return pushEvents->getDroppedCount();
+    }
+
+    quint64 ClientService::getCoalescedPushEventsCount() const {
+        return pushEvents->getCoalescedCount();
+    }
+
+    FrameAllocStats ClientService::getFrameAllocStats() const {
+        return service->getFrameAllocStats();
+    }
+
+    void ClientService::onPushEventsQueued() {
+        const QQueue<PushEvent> events = pushEvents->takeAll();
+
+        for (const PushEvent &evt: events) {
+            switch (evt.cmd) {
+                case PWTS::DCMD::BATTERY_STATUS_CHANGED:
+                    emit batteryStatusChanged(evt.errors, evt.name);
+                    break;
+                case PWTS::DCMD::SYS_WAKE_FROM_SLEEP:
+                    emit wakeFromSleepEvent(evt.errors);
+                    break;
+                case PWTS::DCMD::APPLY_TIMER:
+                    emit applyTimerTick(evt.errors);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    void ClientService::loadCachedDeviceInfo(const QString &adr, const quint16 port) {
+        PWTS::DeviceInfoPacket packet;
+
+        if (!deviceInfoCache->load(adr, port, packet, deviceInfoHash)) {
+            deviceInfoHash.clear();
+            return;
+        }
+
+        // validated by the first device info reply once connected
+        deviceInfoValidationPending = true;
+        cache.deviceInfoPacket = packet;
+        emit deviceInfoPacketReceived(packet);
+    }
+
+    void ClientService::onCommandFailed() {
+        // the validation reply may never come, never swallow the reply of a later request
+        deviceInfoValidationPending = false;
+        emit commandFailed();
+    }
+
+    void ClientService::onDeviceInfoPacketReceived(const PWTS::DeviceInfoPacket &packet) {
+        const bool isValidationReply = std::exchange(deviceInfoValidationPending, false);
+        QByteArray payload;
+        QByteArray hash;
+
+        cache.deviceInfoPacket = packet;
+
+        if (!deviceInfoCacheEnabled || !DeviceInfoCache::fingerprint(packet, payload, hash)) {
+            emit deviceInfoPacketReceived(packet);
+            return;
+        }
+
+        if (hash == deviceInfoHash) {
+            if (!isValidationReply)
+                emit deviceInfoPacketReceived(packet);
+
+            return;
+        }
+
+        deviceInfoHash = hash;
+
+        if (!deviceInfoCache->store(saddr, sport, payload, hash))
+            emit logMessageSent(QString("[%1]: failed to write device info cache").arg(saddr));
+
+        emit deviceInfoPacketReceived(packet);
+    }
+
+    void ClientService::onPrefetchCompleted(const qint64 elapsedMs) {
+        startupLatencyMs = elapsedMs;
+        emit prefetchCompleted(elapsedMs);
+    }
+
     void ClientService::onServiceConnected(const QString &adr, const quint16 port) {
         saddr = adr;
         sport = port;
         connected = true;
 
         emit serviceConnected();
+
+        if (deviceInfoValidationPending && !prefetchCmds.contains(PWTS::DCMD::GET_DEVICE_INFO_PACKET))
+            emit workerSendGetDeviceInfoPacketRequest();
     }
 
     void ClientService::onServiceDisconnected() {
         saddr = "";
         sport = -1;
         connected = false;
+        cache.clear();
         emit serviceDisconnected();
     }
 
@@ -20,13 +20,18 @@
 #include <QThread>
 
 #include "serviceExport.h"
+#include "FrameAllocStats.h"
+#include "ClientServiceCache.h"
 #include "pwtShared/Include/Packets/DeviceInfoPacket.h"
 #include "pwtShared/Include/Packets/ClientPacket.h"
 #include "pwtShared/Include/Packets/DaemonPacket.h"
+#include "pwtShared/Include/DaemonCMD.h"
 #include "../version.h"
 
 namespace PWTCS {
     class ServiceWorker;
+    class PushEventQueue;
+    class DeviceInfoCache;
 
     class PWTCSERVICE_EXPORT ClientService final: public QObject {
         Q_OBJECT
@@ -35,10 +40,21 @@ namespace PWTCS {
         PWTS::CPUVendor cpuVendor = PWTS::CPUVendor::Unknown;
         PWTS::OSType osType = PWTS::OSType::Unknown;
         bool connected = false;
+        bool deviceInfoCacheEnabled = false;
+        bool deviceInfoValidationPending = false;
         quint16 sport = -1;
+        qint64 startupLatencyMs = -1;
+        double healthScore = 1;
         QString saddr;
+        ClientServiceCache cache;
+        QByteArray deviceInfoHash;
+        QList<PWTS::DCMD> prefetchCmds;
         QThread *serviceThread;
         ServiceWorker *service;
+        PushEventQueue *pushEvents;
+        DeviceInfoCache *deviceInfoCache;
+
+        void loadCachedDeviceInfo(const QString &adr, quint16 port);
 
     public:
         ClientService();
@@ -49,6 +65,11 @@ namespace PWTCS {
         [[nodiscard]] bool isConnected() const { return connected; }
         [[nodiscard]] QString getDaemonAddress() const { return saddr; }
         [[nodiscard]] quint16 getDaemonPort() const { return sport; }
+        [[nodiscard]] const ClientServiceCache &getCache() const { return cache; }
+        [[nodiscard]] qint64 getStartupLatencyMs() const { return startupLatencyMs; }
+        [[nodiscard]] double getDaemonHealthScore() const { return healthScore; }
+        [[nodiscard]] bool isDeviceInfoCacheEnabled() const { return deviceInfoCacheEnabled; }
+        void setDeviceInfoCacheEnabled(const bool enable) { deviceInfoCacheEnabled = enable; }
         void disconnectFromDaemon() { emit workerDisconnectFromDaemon(); }
         void sendGetDeviceInfoPacketRequest() { emit workerSendGetDeviceInfoPacketRequest(); }
         void sendGetDaemonPacketRequest() { emit workerSendGetDaemonPacketRequest(); }
@@ -62,27 +83,41 @@ namespace PWTCS {
         void sendExportProfilesRequest(const QString &name) { emit workerSendExportProfilesRequest(name); }
         void sendImportProfilesRequest(const QHash<QString, QByteArray> &profiles) { emit workerSendImportProfilesRequest(profiles); }
         void sendApplyDaemonSettingsRequest(const QByteArray &data) { emit workerSendApplyDaemonSettingsRequest(data); }
+        void sendSyncProfilesRequest(const QHash<QString, QByteArray> &profiles) { emit workerSendSyncProfilesRequest(profiles); }
+        void clearProfileSyncState() { emit workerClearProfileSyncState(); }
 
         void connectToDaemon(const QString &adr, quint16 port);
+        void setReadBufferSize(qint64 size);
+        void setMaxFrameSize(qint64 size);
+        void setPrefetchCommands(const QList<PWTS::DCMD> &cmds);
+        void startSessionCapture(const QString &path) { emit workerStartCapture(path); }
+        void stopSessionCapture() { emit workerStopCapture(); }
+        void setBulkConnectionEnabled(const bool enable) { emit workerSetBulkLaneEnabled(enable); }
+        void setMaxPendingPushEvents(int max);
+        [[nodiscard]] int getMaxPendingPushEvents() const;
+        [[nodiscard]] quint64 getDroppedPushEventsCount() const;
+        [[nodiscard]] quint64 getCoalescedPushEventsCount() const;
+        [[nodiscard]] FrameAllocStats getFrameAllocStats() const;
 
     private slots:
         void onLogMessageSent(const QString &msg) { emit logMessageSent(msg); }
-        void onCommandFailed() { emit commandFailed(); }
-        void onDeviceInfoPacketReceived(const PWTS::DeviceInfoPacket &packet) { emit deviceInfoPacketReceived(packet); }
-        void onDaemonPacketReceived(const PWTS::DaemonPacket &packet) { emit daemonPacketReceived(packet); }
+        void onCommandFailed();
+        void onDeviceInfoPacketReceived(const PWTS::DeviceInfoPacket &packet);
+        void onDaemonPacketReceived(const PWTS::DaemonPacket &packet) { cache.daemonPacket = packet; emit daemonPacketReceived(packet); }
         void onCurrentSettingsApplied(const QSet<PWTS::DError> &errors) { emit settingsApplied(errors); }
         void onDaemonSettingsApplied(const bool success) { emit daemonSettingsApplied(success); }
-        void onBatteryStatusChanged(const QSet<PWTS::DError> &errors, const QString &name) { emit batteryStatusChanged(errors, name); }
-        void onWakeFromSleepEvent(const QSet<PWTS::DError> &errors) { emit wakeFromSleepEvent(errors); }
-        void onApplyTimerTick(const QSet<PWTS::DError> &errors) { emit applyTimerTick(errors); }
-        void onDaemonSettingsReceived(const QByteArray &data) { emit daemonSettingsReceived(data); }
+        void onDaemonSettingsReceived(const QByteArray &data) { cache.daemonSettings = data; emit daemonSettingsReceived(data); }
         void onProfileApplied(const QSet<PWTS::DError> &errors, const QString &name) { emit profileApplied(errors, name); }
-        void onProfileListReceived(const QList<QString> &list) { emit profileListReceived(list); }
+        void onProfileListReceived(const QList<QString> &list) { cache.profileList = list; emit profileListReceived(list); }
+        void onPrefetchCompleted(qint64 elapsedMs);
+        void onDaemonHealthChanged(const double score) { healthScore = score; emit daemonHealthChanged(score); }
+        void onCommandLatency(const PWTS::DCMD cmd, const qint64 rttMs, const bool duringBulkTransfer) { emit commandLatency(cmd, rttMs, duringBulkTransfer); }
         void onProfileDeleted(const bool result) { emit profileDeleted(result); }
         void onProfileWritten(const bool result) { emit profileWritten(result); }
         void onProfilesExported(const QHash<QString, QByteArray> &exported) { emit profilesExported(exported); }
         void onProfilesImported(const bool result) { emit profilesImported(result); }
 
+        void onPushEventsQueued();
         void onServiceConnected(const QString &adr, quint16 port);
         void onServiceDisconnected();
         void onServiceError();
@@ -90,6 +125,12 @@ namespace PWTCS {
     signals:
         void workerDisconnectFromDaemon();
         void workerConnectToDaemon(const QString &adr, quint16 port);
+        void workerSetReadBufferSize(qint64 size);
+        void workerSetMaxFrameSize(qint64 size);
+        void workerSetPrefetchCommands(const QList<PWTS::DCMD> &cmds);
+        void workerStartCapture(const QString &path);
+        void workerStopCapture();
+        void workerSetBulkLaneEnabled(bool enable);
         void workerSendGetDeviceInfoPacketRequest();
         void workerSendGetDaemonPacketRequest();
         void workerSendApplySettingsRequest(const PWTS::ClientPacket &packet);
@@ -102,10 +143,15 @@ namespace PWTCS {
         void workerSendApplyProfileRequest(const QString &name);
         void workerSendExportProfilesRequest(const QString &name);
         void workerSendImportProfilesRequest(const QHash<QString, QByteArray> &profiles);
+        void workerSendSyncProfilesRequest(const QHash<QString, QByteArray> &profiles);
+        void workerClearProfileSyncState();
         void logMessageSent(const QString &msg);
         void serviceError();
         void serviceConnected();
         void serviceDisconnected();
+        void prefetchCompleted(qint64 elapsedMs);
+        void commandLatency(PWTS::DCMD cmd, qint64 rttMs, bool duringBulkTransfer);
+        void daemonHealthChanged(double score);
         void commandFailed();
         void deviceInfoPacketReceived(const PWTS::DeviceInfoPacket &packet);
         void daemonPacketReceived(const PWTS::DaemonPacket &packet);
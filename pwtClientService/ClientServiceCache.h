@@ -0,0 +1,39 @@
+/*
+ * This file is part of PWTClientService.
+ * Copyright (C) 2025 kylon
+ *
+ * PWTClientService is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PWTClientService is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <optional>
+
+#include "pwtShared/Include/Packets/DeviceInfoPacket.h"
+#include "pwtShared/Include/Packets/DaemonPacket.h"
+
+namespace PWTCS {
+    struct ClientServiceCache final {
+        std::optional<PWTS::DeviceInfoPacket> deviceInfoPacket;
+        std::optional<PWTS::DaemonPacket> daemonPacket;
+        std::optional<QByteArray> daemonSettings;
+        std::optional<QList<QString>> profileList;
+
+        void clear() {
+            deviceInfoPacket.reset();
+            daemonPacket.reset();
+            daemonSettings.reset();
+            profileList.reset();
+        }
+    };
+}
@@ -26,16 +26,15 @@ namespace PWTCS {
         Q_OBJECT
 
     private:
-        static constexpr int reqTimeoutMs = 120 * 1000;
         PWTS::DCMD dcmd;
         QString addr;
+        quint64 reqId = 0;
 
     public:
         ClientServiceCmdTimer(const QString &adr, const PWTS::DCMD cmd, QObject *parent = nullptr): QTimer(parent) {
             this->addr = adr;
             this->dcmd = cmd;
 
-            setInterval(reqTimeoutMs);
             setSingleShot(true);
 
             QObject::connect(this, &QTimer::timeout, this, &ClientServiceCmdTimer::onTimeout);
@@ -43,20 +42,22 @@ namespace PWTCS {
 
         [[nodiscard]] QString getAddr() const { return addr; }
         [[nodiscard]] PWTS::DCMD getCMD() const { return dcmd; }
+        [[nodiscard]] quint64 getRequestId() const { return reqId; }
 
-        void reset(const QString &adr, const PWTS::DCMD cmd) {
+        void reset(const QString &adr, const PWTS::DCMD cmd, const quint64 id, const qint64 timeoutMs) {
             this->addr = adr;
             this->dcmd = cmd;
+            this->reqId = id;
 
-            start();
+            start(static_cast<int>(timeoutMs));
         }
 
     private slots:
         void onTimeout() {
-            emit commandTimeout(addr, dcmd);
+            emit commandTimeout(addr, dcmd, reqId);
         };
 
     signals:
-        void commandTimeout(const QString &adr, PWTS::DCMD cmd);
+        void commandTimeout(const QString &adr, PWTS::DCMD cmd, quint64 reqId);
     };
 }
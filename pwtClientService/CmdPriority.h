@@ -0,0 +1,48 @@
+/*
+ * This file is part of PWTClientService.
+ * Copyright (C) 2025 kylon
+ *
+ * PWTClientService is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PWTClientService is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "pwtShared/Include/DaemonCMD.h"
+
+namespace PWTCS {
+    /*
+     * Bulk commands are sent over the bulk connection when it is enabled.
+     * Control and bulk commands always wait the maximum request timeout.
+     */
+    enum class CmdPriority {
+        Control,
+        Normal,
+        Bulk
+    };
+
+    [[nodiscard]] constexpr CmdPriority getCmdPriority(const PWTS::DCMD cmd) {
+        switch (cmd) {
+            case PWTS::DCMD::APPLY_CLIENT_SETTINGS:
+            case PWTS::DCMD::APPLY_PROFILE:
+            case PWTS::DCMD::APPLY_DAEMON_SETT:
+                return CmdPriority::Control;
+            case PWTS::DCMD::EXPORT_PROFILES:
+            case PWTS::DCMD::IMPORT_PROFILES:
+                return CmdPriority::Bulk;
+            default:
+                break;
+        }
+
+        return CmdPriority::Normal;
+    }
+}
@@ -0,0 +1,101 @@
+/*
+ * This file is part of PWTClientService.
+ * Copyright (C) 2025 kylon
+ *
+ * PWTClientService is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PWTClientService is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QHash>
+
+#include "CmdPriority.h"
+
+namespace PWTCS {
+    /*
+     * Per-command request timeout from observed round-trip times, as in RFC 6298:
+     * timeout = srtt + max(granularity, 4 * rttvar), doubled on every timeout.
+     * Commands without samples use the maximum timeout.
+     * Bulk commands always do, their round trip depends on the payload size.
+     * Control commands too, they change daemon state and are not retried, a lost reply leaves the client wrong about it.
+     */
+    class CommandRttEstimator final {
+    private:
+        static constexpr qint64 minTimeoutMs = 2 * 1000;
+        static constexpr qint64 maxTimeoutMs = 120 * 1000;
+        static constexpr qint64 granularityMs = 10;
+        static constexpr double alpha = 1.0 / 8.0;
+        static constexpr double beta = 1.0 / 4.0;
+
+        struct Estimate final {
+            double srtt;
+            double rttvar;
+            qint64 timeoutMs;
+        };
+
+        QHash<PWTS::DCMD, Estimate> estimates;
+
+        [[nodiscard]] static bool hasFixedTimeout(const PWTS::DCMD cmd) {
+            const CmdPriority priority = getCmdPriority(cmd);
+
+            return priority == CmdPriority::Control || priority == CmdPriority::Bulk;
+        }
+
+    public:
+        [[nodiscard]] qint64 getTimeoutMs(const PWTS::DCMD cmd) const {
+            if (hasFixedTimeout(cmd))
+                return maxTimeoutMs;
+
+            const auto it = estimates.constFind(cmd);
+
+            return it != estimates.constEnd() ? it->timeoutMs : maxTimeoutMs;
+        }
+
+        [[nodiscard]] double getSmoothedRttMs(const PWTS::DCMD cmd) const {
+            const auto it = estimates.constFind(cmd);
+
+            return it != estimates.constEnd() ? it->srtt : -1;
+        }
+
+        void clear() { estimates.clear(); }
+
+        void addSample(const PWTS::DCMD cmd, const qint64 rttMs) {
+            if (getCmdPriority(cmd) == CmdPriority::Bulk)
+                return;
+
+            const double rtt = static_cast<double>(rttMs);
+            const auto it = estimates.find(cmd);
+            Estimate est;
+
+            if (it == estimates.end()) {
+                est.srtt = rtt;
+                est.rttvar = rtt / 2;
+
+            } else {
+                est = it.value();
+                est.rttvar = (1 - beta) * est.rttvar + beta * qAbs(est.srtt - rtt);
+                est.srtt = (1 - alpha) * est.srtt + alpha * rtt;
+            }
+
+            est.timeoutMs = qBound(minTimeoutMs, static_cast<qint64>(est.srtt + qMax(static_cast<double>(granularityMs), 4 * est.rttvar)), maxTimeoutMs);
+            estimates.insert(cmd, est);
+        }
+
+        void backoff(const PWTS::DCMD cmd) {
+            const auto it = estimates.find(cmd);
+
+            if (it != estimates.end())
+                it->timeoutMs = qMin(it->timeoutMs * 2, maxTimeoutMs);
+        }
+    };
+}
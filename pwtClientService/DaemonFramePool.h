@@ -0,0 +1,82 @@
+/*
+ * This file is part of PWTClientService.
+ * Copyright (C) 2025 kylon
+ *
+ * PWTClientService is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PWTClientService is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QMutex>
+#include <atomic>
+
+#include "FrameDecoder.h"
+#include "FrameAllocStats.h"
+
+namespace PWTCS {
+    /*
+     * Free list of frames, one per worker and shared by its main and bulk connections,
+     * reused across messages so that steady-state decoding does not allocate frames or grow argument lists.
+     * Decoded payloads inside a frame still allocate.
+     * Frames are acquired on the reader thread and released on the worker thread.
+     * Owns every frame it hands out, must outlive any read in flight.
+     */
+    class DaemonFramePool final {
+    private:
+        QMutex mtx;
+        QList<DaemonFrame *> frames;
+        QList<DaemonFrame *> freeFrames;
+        std::atomic<quint64> framesAllocated = 0;
+        std::atomic<quint64> framesReused = 0;
+        std::atomic<quint64> argsGrowths = 0;
+        std::atomic<quint64> sendBufferGrowths = 0;
+
+    public:
+        ~DaemonFramePool() {
+            qDeleteAll(frames);
+        }
+
+        [[nodiscard]] FrameAllocStats getStats() const {
+            return {
+                .framesAllocated = framesAllocated.load(std::memory_order_relaxed),
+                .framesReused = framesReused.load(std::memory_order_relaxed),
+                .argsGrowths = argsGrowths.load(std::memory_order_relaxed),
+                .sendBufferGrowths = sendBufferGrowths.load(std::memory_order_relaxed)
+            };
+        }
+
+        void countArgsGrowth() { argsGrowths.fetch_add(1, std::memory_order_relaxed); }
+        void countSendBufferGrowth() { sendBufferGrowths.fetch_add(1, std::memory_order_relaxed); }
+
+        [[nodiscard]] DaemonFrame *acquire() {
+            const QMutexLocker lock {&mtx};
+
+            if (!freeFrames.isEmpty()) {
+                framesReused.fetch_add(1, std::memory_order_relaxed);
+                return freeFrames.takeLast();
+            }
+
+            framesAllocated.fetch_add(1, std::memory_order_relaxed);
+            frames.append(new DaemonFrame());
+            return frames.last();
+        }
+
+        void release(DaemonFrame *frame) {
+            frame->reset();
+
+            const QMutexLocker lock {&mtx};
+
+            freeFrames.append(frame);
+        }
+    };
+}
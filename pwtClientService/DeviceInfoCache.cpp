@@ -0,0 +1,101 @@
+/*
+ * This file is part of PWTClientService.
+ * Copyright (C) 2025 kylon
+ *
+ * PWTClientService is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PWTClientService is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QSaveFile>
+#include <QFile>
+#include <QDir>
+
+#include "DeviceInfoCache.h"
+#include "pwtShared/Utils.h"
+
+namespace PWTCS {
+    DeviceInfoCache::DeviceInfoCache() {
+        cacheDir = QString("%1/PWTClientService").arg(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation));
+    }
+
+    QString DeviceInfoCache::getCachePath(const QString &adr, const quint16 port) const {
+        const QByteArray key = QCryptographicHash::hash(QString("%1:%2").arg(adr).arg(port).toUtf8(), QCryptographicHash::Sha1);
+
+        return QString("%1/%2.dinfo").arg(cacheDir, QString::fromLatin1(key.toHex()));
+    }
+
+    bool DeviceInfoCache::fingerprint(const PWTS::DeviceInfoPacket &packet, QByteArray &payload, QByteArray &hash) {
+        if (!PWTS::packData<QVariant>(QVariant::fromValue<PWTS::DeviceInfoPacket>(packet), payload))
+            return false;
+
+        hash = QCryptographicHash::hash(payload, QCryptographicHash::Sha256);
+        return true;
+    }
+
+    bool DeviceInfoCache::load(const QString &adr, const quint16 port, PWTS::DeviceInfoPacket &packet, QByteArray &hash) const {
+        QFile file {getCachePath(adr, port)};
+
+        if (!file.open(QIODevice::ReadOnly) || file.size() == 0)
+            return false;
+
+        uchar *mem = file.map(0, file.size());
+
+        if (mem == nullptr)
+            return false;
+
+        QDataStream ds {QByteArray::fromRawData(reinterpret_cast<const char *>(mem), file.size())};
+        QByteArray payload;
+        QVariant var;
+        quint32 magic;
+        quint16 version;
+
+        ds.setVersion(QDataStream::Qt_6_0);
+        ds >> magic >> version;
+
+        if (ds.status() != QDataStream::Ok || magic != fileMagic || version != fileVersion) {
+            file.unmap(mem);
+            return false;
+        }
+
+        ds >> hash >> payload;
+        file.unmap(mem);
+
+        // a stale hash would hide a fresh packet that differs from the cached one
+        if (ds.status() != QDataStream::Ok || QCryptographicHash::hash(payload, QCryptographicHash::Sha256) != hash)
+            return false;
+
+        if (!PWTS::unpackData<QVariant>(payload, var) || !var.canConvert<PWTS::DeviceInfoPacket>())
+            return false;
+
+        packet = var.value<PWTS::DeviceInfoPacket>();
+        return packet.error == PWTS::PacketError::NoError;
+    }
+
+    bool DeviceInfoCache::store(const QString &adr, const quint16 port, const QByteArray &payload, const QByteArray &hash) const {
+        if (!QDir().mkpath(cacheDir))
+            return false;
+
+        QSaveFile file {getCachePath(adr, port)};
+
+        if (!file.open(QIODevice::WriteOnly))
+            return false;
+
+        QDataStream ds {&file};
+
+        ds.setVersion(QDataStream::Qt_6_0);
+        ds << fileMagic << fileVersion << hash << payload;
+
+        return ds.status() == QDataStream::Ok && file.commit();
+    }
+}
@@ -0,0 +1,44 @@
+/*
+ * This file is part of PWTClientService.
+ * Copyright (C) 2025 kylon
+ *
+ * PWTClientService is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PWTClientService is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "pwtShared/Include/Packets/DeviceInfoPacket.h"
+
+namespace PWTCS {
+    /*
+     * On-disk cache of the last device info packet received from each daemon.
+     * Entries are keyed by daemon address and store the packet fingerprint,
+     * so a fresh packet can be compared without re-parsing the cached one.
+     * Entries whose fingerprint does not match their payload are rejected.
+     */
+    class DeviceInfoCache final {
+    private:
+        static constexpr quint32 fileMagic = 0x50574443;
+        static constexpr quint16 fileVersion = 1;
+        QString cacheDir;
+
+        [[nodiscard]] QString getCachePath(const QString &adr, quint16 port) const;
+
+    public:
+        DeviceInfoCache();
+
+        [[nodiscard]] static bool fingerprint(const PWTS::DeviceInfoPacket &packet, QByteArray &payload, QByteArray &hash);
+        [[nodiscard]] bool load(const QString &adr, quint16 port, PWTS::DeviceInfoPacket &packet, QByteArray &hash) const;
+        [[nodiscard]] bool store(const QString &adr, quint16 port, const QByteArray &payload, const QByteArray &hash) const;
+    };
+}
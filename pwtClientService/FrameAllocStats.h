@@ -0,0 +1,30 @@
+/*
+ * This file is part of PWTClientService.
+ * Copyright (C) 2025 kylon
+ *
+ * PWTClientService is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PWTClientService is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QtTypes>
+
+namespace PWTCS {
+    // frame pool misses and buffer capacity growths, payload allocations are not counted
+    struct FrameAllocStats final {
+        quint64 framesAllocated = 0;
+        quint64 framesReused = 0;
+        quint64 argsGrowths = 0;
+        quint64 sendBufferGrowths = 0;
+    };
+}
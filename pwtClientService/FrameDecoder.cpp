@@ -0,0 +1,197 @@
+/*
+ * This file is part of PWTClientService.
+ * Copyright (C) 2025 kylon
+ *
+ * PWTClientService is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PWTClientService is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "FrameDecoder.h"
+#include "pwtShared/Include/Packets/ClientPacket.h"
+#include "pwtShared/Utils.h"
+
+namespace PWTCS {
+    bool FrameEncoder::pack() {
+        buffer.resize(0);
+
+        return PWTS::packData<QList<QVariant>>(args, buffer);
+    }
+
+    void FrameDecoder::registerTypes() {
+        qRegisterMetaType<PWTS::DeviceInfoPacket>();
+        qRegisterMetaType<PWTS::ClientPacket>();
+        qRegisterMetaType<PWTS::DaemonPacket>();
+    }
+
+    bool FrameDecoder::readFrame(QDataStream &ds, QList<QVariant> &args) {
+        ds.startTransaction();
+        ds >> args;
+
+        return ds.commitTransaction();
+    }
+
+    bool FrameDecoder::hasValidMessageArgs(const QList<QVariant> &args) {
+        bool isInt;
+
+        if (args.isEmpty())
+            return false;
+
+        const int cmd = args[0].toInt(&isInt);
+
+        if (!isInt)
+            return false;
+
+        switch (static_cast<PWTS::DCMD>(cmd)) {
+            case PWTS::DCMD::DAEMON_CMD_FAIL:
+            case PWTS::DCMD::PRINT_ERROR:
+            case PWTS::DCMD::GET_DEVICE_INFO_PACKET:
+            case PWTS::DCMD::GET_DAEMON_PACKET:
+            case PWTS::DCMD::GET_DAEMON_SETTS:
+            case PWTS::DCMD::APPLY_CLIENT_SETTINGS:
+            case PWTS::DCMD::DELETE_PROFILE:
+            case PWTS::DCMD::WRITE_PROFILE:
+            case PWTS::DCMD::GET_PROFILE_LIST:
+            case PWTS::DCMD::EXPORT_PROFILES:
+            case PWTS::DCMD::IMPORT_PROFILES:
+            case PWTS::DCMD::APPLY_TIMER:
+            case PWTS::DCMD::APPLY_DAEMON_SETT:
+            case PWTS::DCMD::SYS_WAKE_FROM_SLEEP: {
+                if (args.size() < 2)
+                    return false;
+            }
+                break;
+            case PWTS::DCMD::APPLY_PROFILE:
+            case PWTS::DCMD::LOAD_PROFILE:
+            case PWTS::DCMD::BATTERY_STATUS_CHANGED: {
+                if (args.size() < 3)
+                    return false;
+            }
+                break;
+            default:
+                break;
+        }
+
+        return true;
+    }
+
+    void FrameDecoder::decode(DaemonFrame &frame) {
+        const QList<QVariant> &args = frame.args;
+
+        if (!hasValidMessageArgs(args)) {
+            frame.invalid = true;
+            frame.error = QStringLiteral("FrameDecoder: args is invalid");
+            return;
+        }
+
+        frame.cmd = static_cast<PWTS::DCMD>(args[0].toInt());
+
+        switch (frame.cmd) {
+            case PWTS::DCMD::PRINT_ERROR:
+                frame.error = PWTS::getErrorStr(static_cast<PWTS::DError>(args[1].toInt()));
+                break;
+            case PWTS::DCMD::DAEMON_CMD_FAIL:
+                frame.failedCmd = static_cast<PWTS::DCMD>(args[1].toInt());
+                break;
+            case PWTS::DCMD::GET_DEVICE_INFO_PACKET: {
+                if (!args[1].canConvert<PWTS::DeviceInfoPacket>()) {
+                    frame.error = QStringLiteral("Unable to unpack device info packet");
+                    break;
+                }
+
+                frame.deviceInfoPacket = args[1].value<PWTS::DeviceInfoPacket>();
+
+                if (frame.deviceInfoPacket.error != PWTS::PacketError::NoError) {
+                    frame.error = PWTS::getPacketErrorStr(frame.deviceInfoPacket.error);
+                    frame.rawError = true;
+                }
+            }
+                break;
+            case PWTS::DCMD::GET_DAEMON_PACKET: {
+                if (!args[1].canConvert<PWTS::DaemonPacket>()) {
+                    frame.error = QStringLiteral("Unable to unpack daemon packet");
+                    break;
+                }
+
+                frame.daemonPacket = args[1].value<PWTS::DaemonPacket>();
+
+                if (frame.daemonPacket.error != PWTS::PacketError::NoError) {
+                    frame.error = PWTS::getPacketErrorStr(frame.daemonPacket.error);
+                    frame.rawError = true;
+                }
+            }
+                break;
+            case PWTS::DCMD::GET_DAEMON_SETTS: {
+                frame.data = args[1].toByteArray();
+
+                if (frame.data.isEmpty())
+                    frame.error = QStringLiteral("Unable to get daemon settings");
+            }
+                break;
+            case PWTS::DCMD::APPLY_CLIENT_SETTINGS: {
+                if (!PWTS::unpackData<QSet<PWTS::DError>>(args[1].toByteArray(), frame.errors))
+                    frame.error = QStringLiteral("Unable to get apply settings result");
+            }
+                break;
+            case PWTS::DCMD::DELETE_PROFILE:
+            case PWTS::DCMD::WRITE_PROFILE:
+            case PWTS::DCMD::IMPORT_PROFILES:
+            case PWTS::DCMD::APPLY_DAEMON_SETT:
+                frame.result = args[1].toBool();
+                break;
+            case PWTS::DCMD::GET_PROFILE_LIST:
+                frame.list = args[1].toStringList();
+                break;
+            case PWTS::DCMD::APPLY_PROFILE: {
+                if (!PWTS::unpackData<QSet<PWTS::DError>>(args[1].toByteArray(), frame.errors))
+                    frame.error = QStringLiteral("Unable to get apply profile result");
+                else
+                    frame.name = args[2].toString();
+            }
+                break;
+            case PWTS::DCMD::LOAD_PROFILE: {
+                if (!args[1].canConvert<PWTS::DaemonPacket>()) {
+                    frame.error = QStringLiteral("Unable to unpack daemon packet");
+                    break;
+                }
+
+                frame.name = args[2].toString();
+                frame.daemonPacket = args[1].value<PWTS::DaemonPacket>();
+            }
+                break;
+            case PWTS::DCMD::EXPORT_PROFILES: {
+                if (!PWTS::unpackData<QHash<QString, QByteArray>>(args[1].toByteArray(), frame.profiles))
+                    frame.error = QStringLiteral("Failed to get exported profiles data");
+            }
+                break;
+            case PWTS::DCMD::BATTERY_STATUS_CHANGED: {
+                if (!PWTS::unpackData<QSet<PWTS::DError>>(args[1].toByteArray(), frame.errors))
+                    frame.error = QStringLiteral("Unable to get battery status change event result");
+                else
+                    frame.name = args[2].toString();
+            }
+                break;
+            case PWTS::DCMD::SYS_WAKE_FROM_SLEEP: {
+                if (!PWTS::unpackData<QSet<PWTS::DError>>(args[1].toByteArray(), frame.errors))
+                    frame.error = QStringLiteral("Unable to get wake from sleep event result");
+            }
+                break;
+            case PWTS::DCMD::APPLY_TIMER: {
+                if (!PWTS::unpackData<QSet<PWTS::DError>>(args[1].toByteArray(), frame.errors))
+                    frame.error = QStringLiteral("Unable to get apply timer result");
+            }
+                break;
+            default:
+                frame.error = QString("unknown cmd %1").arg(static_cast<int>(frame.cmd));
+                break;
+        }
+    }
+}
@@ -0,0 +1,97 @@
+/*
+ * This file is part of PWTClientService.
+ * Copyright (C) 2025 kylon
+ *
+ * PWTClientService is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PWTClientService is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QElapsedTimer>
+#include <QDataStream>
+#include <QVariant>
+#include <QHash>
+#include <QSet>
+
+#include "pwtShared/Include/Packets/DeviceInfoPacket.h"
+#include "pwtShared/Include/Packets/DaemonPacket.h"
+#include "pwtShared/Include/DaemonCMD.h"
+
+namespace PWTCS {
+    struct DaemonFrame final {
+        QList<QVariant> args;
+        QByteArray raw;
+        QElapsedTimer received;
+        quint64 requestId = 0;
+        PWTS::DCMD cmd {};
+        PWTS::DCMD failedCmd {};
+        bool invalid = false;
+        QString error;
+        bool rawError = false;
+        bool result = false;
+        QString name;
+        QByteArray data;
+        QList<QString> list;
+        QSet<PWTS::DError> errors;
+        QHash<QString, QByteArray> profiles;
+        PWTS::DeviceInfoPacket deviceInfoPacket;
+        PWTS::DaemonPacket daemonPacket;
+
+        // args keeps its capacity, it is the receive buffer of the next frame
+        void reset() {
+            args.clear();
+            raw.clear();
+            received.invalidate();
+            requestId = 0;
+            cmd = {};
+            failedCmd = {};
+            invalid = false;
+            error.clear();
+            rawError = false;
+            result = false;
+            name.clear();
+            data.clear();
+            list.clear();
+            errors.clear();
+            profiles.clear();
+            deviceInfoPacket = {};
+            daemonPacket = {};
+        }
+    };
+
+    class FrameEncoder final {
+    private:
+        QList<QVariant> args;
+        QByteArray buffer;
+
+    public:
+        [[nodiscard]] const QByteArray &getBuffer() const { return buffer; }
+
+        template <typename... Args>
+        void setArgs(const PWTS::DCMD cmd, const Args &...cmdArgs) {
+            args.clear();
+            args.append(static_cast<int>(cmd));
+            (args.append(QVariant::fromValue(cmdArgs)), ...);
+        }
+
+        [[nodiscard]] bool pack();
+    };
+
+    class FrameDecoder final {
+    public:
+        static void registerTypes();
+        [[nodiscard]] static bool readFrame(QDataStream &ds, QList<QVariant> &args);
+        [[nodiscard]] static bool hasValidMessageArgs(const QList<QVariant> &args);
+        static void decode(DaemonFrame &frame);
+    };
+}
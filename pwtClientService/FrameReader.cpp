@@ -0,0 +1,73 @@
+/*
+ * This file is part of PWTClientService.
+ * Copyright (C) 2025 kylon
+ *
+ * PWTClientService is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PWTClientService is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "FrameReader.h"
+
+namespace PWTCS {
+    void FrameReader::appendData(const quint64 epoch, const bool bulkLane, const QByteArray &data, const bool capture) {
+        Lane &lane = bulkLane ? bulkInbound : mainInbound;
+        QList<DaemonFrame *> frames;
+        qint64 readBytes = 0;
+
+        // the connection was reset, its incomplete frame will never be completed
+        if (lane.epoch != epoch) {
+            lane.epoch = epoch;
+            lane.inbound.clear();
+        }
+
+        lane.inbound.append(data);
+
+        {
+            QDataStream ds {lane.inbound};
+            const QIODevice *dev = ds.device();
+
+            while (true) {
+                DaemonFrame *frame = framePool->acquire();
+                const qsizetype argsCapacity = frame->args.capacity();
+
+                // QVariant deserialization is most of the cost of packet replies, time it too
+                frame->received.start();
+
+                const bool hasFrame = FrameDecoder::readFrame(ds, frame->args);
+
+                if (frame->args.capacity() > argsCapacity)
+                    framePool->countArgsGrowth();
+
+                // corrupt data is consumed by the read, an incomplete frame is not
+                if (!hasFrame) {
+                    readBytes = dev->pos();
+                    framePool->release(frame);
+                    break;
+                }
+
+                // only the bytes of this frame are copied
+                if (capture)
+                    frame->raw = lane.inbound.sliced(readBytes, dev->pos() - readBytes);
+
+                readBytes = dev->pos();
+
+                if (!frame->args.isEmpty())
+                    FrameDecoder::decode(*frame);
+
+                frames.append(frame);
+            }
+        }
+
+        lane.inbound.remove(0, readBytes);
+        emit framesRead(epoch, bulkLane, frames, data.size(), lane.inbound.size());
+    }
+}
@@ -0,0 +1,53 @@
+/*
+ * This file is part of PWTClientService.
+ * Copyright (C) 2025 kylon
+ *
+ * PWTClientService is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PWTClientService is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QObject>
+
+#include "DaemonFramePool.h"
+
+namespace PWTCS {
+    /*
+     * Reads and decodes the frames of the worker connections on its own thread.
+     * The worker only hands over the bytes received on each connection, frames are
+     * read from them in order and handed back in the order they were received.
+     */
+    class FrameReader final: public QObject {
+        Q_OBJECT
+
+    private:
+        struct Lane final {
+            quint64 epoch = 0;
+            QByteArray inbound;
+        };
+
+        DaemonFramePool *framePool;
+        Lane mainInbound;
+        Lane bulkInbound;
+
+    public:
+        explicit FrameReader(DaemonFramePool *pool): framePool(pool) {}
+
+    public slots:
+        void appendData(quint64 epoch, bool bulkLane, const QByteArray &data, bool capture);
+
+    signals:
+        // appended: size of the data handed over, pending: bytes of an incomplete frame kept for the next data
+        void framesRead(quint64 epoch, bool bulkLane, const QList<PWTCS::DaemonFrame *> &frames, qint64 appended, qint64 pending);
+    };
+}
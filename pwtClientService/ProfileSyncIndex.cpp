@@ -0,0 +1,124 @@
+/*
+ * This file is part of PWTClientService.
+ * Copyright (C) 2025 kylon
+ *
+ * PWTClientService is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PWTClientService is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <QCryptographicHash>
+
+#include "ProfileSyncIndex.h"
+
+namespace PWTCS {
+    QByteArray ProfileSyncIndex::hashProfile(const QByteArray &data) {
+        return QCryptographicHash::hash(data, QCryptographicHash::Sha256);
+    }
+
+    void ProfileSyncIndex::clear() {
+        pending.clear();
+        daemonProfiles.clear();
+    }
+
+    QHash<QString, QByteArray> ProfileSyncIndex::getChangedProfiles(const QString &daemon, const QHash<QString, QByteArray> &profiles) const {
+        const QHash<QString, QByteArray> known = daemonProfiles.value(daemon);
+        QHash<QString, QByteArray> changed;
+
+        for (const auto &[name, data]: profiles.asKeyValueRange()) {
+            const auto it = known.constFind(name);
+
+            if (it == known.constEnd() || it.value() != hashProfile(data))
+                changed.insert(name, data);
+        }
+
+        return changed;
+    }
+
+    void ProfileSyncIndex::updateFromExport(const QString &daemon, const QHash<QString, QByteArray> &profiles) {
+        QHash<QString, QByteArray> &known = daemonProfiles[daemon];
+
+        for (auto it = profiles.cbegin(); it != profiles.cend(); ++it)
+            known.insert(it.key(), hashProfile(it.value()));
+    }
+
+    void ProfileSyncIndex::beginImport(const quint64 reqId, const QHash<QString, QByteArray> &profiles) {
+        PendingRequest req {.op = PendingOp::Import};
+
+        for (auto it = profiles.cbegin(); it != profiles.cend(); ++it)
+            req.hashes.insert(it.key(), hashProfile(it.value()));
+
+        pending.insert(reqId, req);
+    }
+
+    void ProfileSyncIndex::beginDelete(const quint64 reqId, const QString &name) {
+        pending.insert(reqId, {.op = PendingOp::Delete, .name = name});
+    }
+
+    void ProfileSyncIndex::beginWrite(const quint64 reqId, const QString &name) {
+        pending.insert(reqId, {.op = PendingOp::Write, .name = name});
+    }
+
+    void ProfileSyncIndex::forgetProfiles(const QString &daemon, const PendingRequest &req) {
+        if (!daemonProfiles.contains(daemon))
+            return;
+
+        QHash<QString, QByteArray> &known = daemonProfiles[daemon];
+
+        if (req.op == PendingOp::Import) {
+            for (auto it = req.hashes.cbegin(); it != req.hashes.cend(); ++it)
+                known.remove(it.key());
+
+        } else {
+            known.remove(req.name);
+        }
+    }
+
+    void ProfileSyncIndex::endRequest(const QString &daemon, const quint64 reqId, const bool success) {
+        const auto it = pending.constFind(reqId);
+
+        if (it == pending.constEnd())
+            return;
+
+        const PendingRequest req = it.value();
+
+        pending.erase(it);
+
+        if (success) {
+            // written content is a client packet, its exported form is unknown until the next export
+            if (req.op == PendingOp::Import)
+                daemonProfiles[daemon].insert(req.hashes);
+            else
+                forgetProfiles(daemon, req);
+        }
+    }
+
+    // the daemon may or may not have run the request, forget what it touched so the next sync sends it again
+    void ProfileSyncIndex::abortRequest(const QString &daemon, const quint64 reqId) {
+        const auto it = pending.constFind(reqId);
+
+        if (it == pending.constEnd())
+            return;
+
+        forgetProfiles(daemon, it.value());
+        pending.erase(it);
+    }
+
+    void ProfileSyncIndex::abortPending(const QString &daemon) {
+        if (pending.isEmpty())
+            return;
+
+        for (const PendingRequest &req: std::as_const(pending))
+            forgetProfiles(daemon, req);
+
+        pending.clear();
+    }
+}
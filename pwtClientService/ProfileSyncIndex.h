@@ -0,0 +1,62 @@
+/*
+ * This file is part of PWTClientService.
+ * Copyright (C) 2025 kylon
+ *
+ * PWTClientService is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PWTClientService is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QHash>
+
+namespace PWTCS {
+    /*
+     * Content hashes of the profiles this client last saw on each daemon,
+     * learned from exports and successful imports, writes and deletes.
+     * Only hashes are kept, profile data is never stored.
+     * Changes made to a daemon by other clients are not seen until the next export.
+     * Pending operations are keyed by the id of the request that carries them.
+     */
+    class ProfileSyncIndex final {
+    private:
+        enum class PendingOp {
+            Import,
+            Delete,
+            Write
+        };
+
+        struct PendingRequest final {
+            PendingOp op;
+            QString name;
+            QHash<QString, QByteArray> hashes;
+        };
+
+        QHash<QString, QHash<QString, QByteArray>> daemonProfiles;
+        QHash<quint64, PendingRequest> pending;
+
+        void forgetProfiles(const QString &daemon, const PendingRequest &req);
+
+    public:
+        [[nodiscard]] static QByteArray hashProfile(const QByteArray &data);
+
+        void clear();
+        [[nodiscard]] QHash<QString, QByteArray> getChangedProfiles(const QString &daemon, const QHash<QString, QByteArray> &profiles) const;
+        void updateFromExport(const QString &daemon, const QHash<QString, QByteArray> &profiles);
+        void beginImport(quint64 reqId, const QHash<QString, QByteArray> &profiles);
+        void beginDelete(quint64 reqId, const QString &name);
+        void beginWrite(quint64 reqId, const QString &name);
+        void endRequest(const QString &daemon, quint64 reqId, bool success);
+        void abortRequest(const QString &daemon, quint64 reqId);
+        void abortPending(const QString &daemon);
+    };
+}
@@ -0,0 +1,105 @@
+/*
+ * This file is part of PWTClientService.
+ * Copyright (C) 2025 kylon
+ *
+ * PWTClientService is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PWTClientService is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QMutex>
+#include <QQueue>
+#include <QSet>
+#include <utility>
+
+#include "pwtShared/Include/Packets/DaemonPacket.h"
+#include "pwtShared/Include/DaemonCMD.h"
+
+namespace PWTCS {
+    struct PushEvent final {
+        PWTS::DCMD cmd;
+        QSet<PWTS::DError> errors;
+        QString name;
+    };
+
+    /*
+     * Bounded hand-off for daemon push events between worker and client threads.
+     * Apply timer ticks are coalesced, the oldest event is dropped on overflow.
+     */
+    class PushEventQueue final {
+    private:
+        static constexpr int defaultMaxPending = 64;
+        mutable QMutex mtx;
+        QQueue<PushEvent> queue;
+        int maxPending = defaultMaxPending;
+        quint64 dropped = 0;
+        quint64 coalesced = 0;
+
+        [[nodiscard]] bool coalesce(PushEvent &evt) {
+            if (evt.cmd != PWTS::DCMD::APPLY_TIMER)
+                return false;
+
+            for (qsizetype i = 0; i < queue.size(); ++i) {
+                if (queue[i].cmd != evt.cmd)
+                    continue;
+
+                // the latest tick takes the place of the stale one, behind events received before it
+                queue.removeAt(i);
+                queue.enqueue(std::move(evt));
+                ++coalesced;
+                return true;
+            }
+
+            return false;
+        }
+
+    public:
+        [[nodiscard]] quint64 getDroppedCount() const { const QMutexLocker lock {&mtx}; return dropped; }
+        [[nodiscard]] quint64 getCoalescedCount() const { const QMutexLocker lock {&mtx}; return coalesced; }
+        [[nodiscard]] int getMaxPending() const { const QMutexLocker lock {&mtx}; return maxPending; }
+
+        void setMaxPending(const int max) {
+            const QMutexLocker lock {&mtx};
+
+            maxPending = qMax(1, max);
+
+            while (queue.size() > maxPending) {
+                queue.dequeue();
+                ++dropped;
+            }
+        }
+
+        // returns true when the queue was empty, the consumer must be notified
+        bool push(PushEvent &&evt) {
+            const QMutexLocker lock {&mtx};
+            const bool wasEmpty = queue.isEmpty();
+
+            if (coalesce(evt))
+                return wasEmpty;
+
+            if (queue.size() >= maxPending) {
+                queue.dequeue();
+                ++dropped;
+            }
+
+            queue.enqueue(std::move(evt));
+            return wasEmpty;
+        }
+
+        [[nodiscard]] QQueue<PushEvent> takeAll() {
+            const QMutexLocker lock {&mtx};
+
+            return std::exchange(queue, {});
+        }
+    };
+}
@@ -21,71 +21,163 @@
 namespace PWTCS {
     ServiceWorker::~ServiceWorker() {
         abortSocket();
+        readerThread->quit();
+        readerThread->wait();
+        delete readerThread;
 
         for (const ClientServiceCmdTimer *tm: reqTimerPool)
             delete tm;
 
+        delete bulkSock;
         delete sock;
     }
 
     void ServiceWorker::init() {
-        qRegisterMetaType<PWTS::DeviceInfoPacket>();
-        qRegisterMetaType<PWTS::ClientPacket>();
-        qRegisterMetaType<PWTS::DaemonPacket>();
+        FrameDecoder::registerTypes();
+
+        frameReader = new FrameReader(&framePool);
+        readerThread = new QThread();
+
+        frameReader->moveToThread(readerThread);
+
+        QObject::connect(readerThread, &QThread::finished, frameReader, &QObject::deleteLater);
+        QObject::connect(frameReader, &FrameReader::framesRead, this, &ServiceWorker::onFramesRead);
+
+        readerThread->start();
 
         sock = new QTcpSocket();
 
-        sockStreamIn.setDevice(sock);
+        sock->setReadBufferSize(readBufferSize);
 
         QObject::connect(sock, &QTcpSocket::connected, this, &ServiceWorker::onConnected);
         QObject::connect(sock, &QTcpSocket::disconnected, this, &ServiceWorker::onDisconnected);
         QObject::connect(sock, &QTcpSocket::readyRead, this, &ServiceWorker::onReadyRead);
         QObject::connect(sock, &QTcpSocket::errorOccurred, this, &ServiceWorker::onErrorOccurred);
+
+        bulkSock = new QTcpSocket();
+
+        bulkSock->setReadBufferSize(readBufferSize);
+
+        QObject::connect(bulkSock, &QTcpSocket::readyRead, this, &ServiceWorker::onBulkReadyRead);
+        QObject::connect(bulkSock, &QTcpSocket::errorOccurred, this, &ServiceWorker::onBulkErrorOccurred);
     }
 
-    void ServiceWorker::abortSocket() const {
+    void ServiceWorker::abortSocket() {
         const QSignalBlocker sblock {sock};
 
         stopAllTimers();
+        abortBulkSocket();
 
         if (sock->state() != QAbstractSocket::UnconnectedState)
             sock->abort();
 
         sock->close();
+        resetFrameLane(false);
+    }
+
+    void ServiceWorker::abortBulkSocket() {
+        const QSignalBlocker sblock {bulkSock};
+
+        if (bulkSock->state() != QAbstractSocket::UnconnectedState)
+            bulkSock->abort();
+
+        bulkSock->close();
+        resetFrameLane(true);
     }
 
     void ServiceWorker::connectToDaemon(const QString &adr, const quint16 port) {
         abortSocket();
+        clearPendingRequests();
+        pendingPrefetch.clear();
+
+        if (adr != saddr || port != sport)
+            rttEstimator.clear();
 
         saddr = adr;
         sport = port;
+        healthScore = 1;
+        connectTimer.start();
         sock->connectToHost(QHostAddress(adr), port);
+
+        if (bulkLaneEnabled)
+            bulkSock->connectToHost(QHostAddress(adr), port);
     }
 
     void ServiceWorker::disconnectFromDaemon() {
         abortSocket();
+        clearPendingRequests();
 
         if (sock->isOpen())
             emit logMessageSent(QStringLiteral("Failed to close daemon socket"));
     }
 
-    bool ServiceWorker::disconnect() const {
+    void ServiceWorker::setBulkLaneEnabled(const bool enable) {
+        bulkLaneEnabled = enable;
+
+        if (!enable) {
+            abortBulkSocket();
+            failBulkRequests();
+
+        } else if (sock->state() == QAbstractSocket::ConnectedState && bulkSock->state() == QAbstractSocket::UnconnectedState) {
+            bulkSock->connectToHost(QHostAddress(saddr), sport);
+        }
+    }
+
+    QTcpSocket *ServiceWorker::getSocketForCMD(const PWTS::DCMD cmd) const {
+        if (bulkLaneEnabled && getCmdPriority(cmd) == CmdPriority::Bulk && bulkSock->state() == QAbstractSocket::ConnectedState)
+            return bulkSock;
+
+        return sock;
+    }
+
+    bool ServiceWorker::hasActiveBulkRequest() const {
+        for (const PendingRequest &req: pendingRequests) {
+            if (!req.timedOut && getCmdPriority(req.cmd) == CmdPriority::Bulk)
+                return true;
+        }
+
+        return false;
+    }
+
+    void ServiceWorker::setReadBufferSize(const qint64 size) {
+        readBufferSize = qMax<qint64>(0, size);
+        sock->setReadBufferSize(readBufferSize);
+        bulkSock->setReadBufferSize(readBufferSize);
+    }
+
+    void ServiceWorker::setMaxFrameSize(const qint64 size) {
+        maxFrameSize = qMax<qint64>(0, size);
+    }
+
+    bool ServiceWorker::disconnect() {
         abortSocket();
+        clearPendingRequests();
         return !sock->isOpen();
     }
 
-    void ServiceWorker::startRequestTimer(const PWTS::DCMD cmd) {
+    quint64 ServiceWorker::startRequest(const PWTS::DCMD cmd, const bool bulkLane) {
+        const quint64 reqId = nextRequestId++;
+        ClientServiceCmdTimer *timer = nullptr;
+
+        pendingRequests.append({.id = reqId, .cmd = cmd, .bulkLane = bulkLane});
+        pendingRequests.last().sent.start();
+
         for (ClientServiceCmdTimer *tm: reqTimerPool) {
-            if (tm->isActive())
-                continue;
+            if (!tm->isActive()) {
+                timer = tm;
+                break;
+            }
+        }
 
-            tm->reset(saddr, cmd);
-            return;
+        if (timer == nullptr) {
+            timer = new ClientServiceCmdTimer(saddr, cmd, this);
+
+            reqTimerPool.append(timer);
+            QObject::connect(timer, &ClientServiceCmdTimer::commandTimeout, this, &ServiceWorker::onCommandTimeout);
         }
 
-        reqTimerPool.append(new ClientServiceCmdTimer(saddr, cmd, this));
-        QObject::connect(reqTimerPool.last(), &ClientServiceCmdTimer::commandTimeout, this, &ServiceWorker::onCommandTimeout);
-        reqTimerPool.last()->start();
+        timer->reset(saddr, cmd, reqId, rttEstimator.getTimeoutMs(cmd));
+        return reqId;
     }
 
     void ServiceWorker::stopAllTimers() const {
@@ -93,9 +185,9 @@ namespace PWTCS {
             tm->stop();
     }
 
-    void ServiceWorker::stopTimerForCMD(const PWTS::DCMD cmd) const {
+    void ServiceWorker::stopRequestTimer(const quint64 reqId) const {
         for (ClientServiceCmdTimer *tm: reqTimerPool) {
-            if (tm->getAddr() != saddr || tm->getCMD() != cmd)
+            if (!tm->isActive() || tm->getRequestId() != reqId)
                 continue;
 
             tm->stop();
@@ -103,328 +195,318 @@ namespace PWTCS {
         }
     }
 
-    bool ServiceWorker::hasValidMessageArgs(const QList<QVariant> &args) const {
-        if (args.isEmpty())
-            return false;
+    void ServiceWorker::clearPendingRequests() {
+        profileIndex.abortPending(getDaemonKey());
+        pendingRequests.clear();
+    }
+
+    // requests in flight on a closed bulk connection will never be answered
+    void ServiceWorker::failBulkRequests() {
+        QList<quint64> failed;
+
+        pendingRequests.removeIf([&failed](const PendingRequest &req) {
+            if (!req.bulkLane)
+                return false;
+
+            if (!req.timedOut)
+                failed.append(req.id);
+
+            return true;
+        });
+
+        for (const quint64 reqId: failed) {
+            stopRequestTimer(reqId);
+            profileIndex.abortRequest(getDaemonKey(), reqId);
+            emit logMessageSent(setErrorMsg(QStringLiteral("Bulk connection closed with a request in flight")));
+            emit commandFailed();
+        }
+    }
+
+    void ServiceWorker::dropExpiredRequests() {
+        // the daemon never answered, stop waiting for its late reply
+        pendingRequests.removeIf([](const PendingRequest &req) { return req.timedOut && req.lateReplyDeadline.hasExpired(); });
+    }
 
+    bool ServiceWorker::isPushEvent(const QList<QVariant> &args) {
         switch (static_cast<PWTS::DCMD>(args[0].toInt())) {
-            case PWTS::DCMD::DAEMON_CMD_FAIL: {
-                if (args.size() < 1)
-                    return false;
-            }
-                break;
-            case PWTS::DCMD::PRINT_ERROR:
-            case PWTS::DCMD::GET_DAEMON_SETTS:
-            case PWTS::DCMD::APPLY_CLIENT_SETTINGS:
-            case PWTS::DCMD::DELETE_PROFILE:
-            case PWTS::DCMD::WRITE_PROFILE:
-            case PWTS::DCMD::GET_PROFILE_LIST:
-            case PWTS::DCMD::EXPORT_PROFILES:
-            case PWTS::DCMD::IMPORT_PROFILES:
+            case PWTS::DCMD::BATTERY_STATUS_CHANGED:
+            case PWTS::DCMD::SYS_WAKE_FROM_SLEEP:
             case PWTS::DCMD::APPLY_TIMER:
-            case PWTS::DCMD::APPLY_DAEMON_SETT:
-            case PWTS::DCMD::SYS_WAKE_FROM_SLEEP: {
-                if (args.size() < 2)
-                    return false;
-            }
-                break;
-            case PWTS::DCMD::APPLY_PROFILE:
-            case PWTS::DCMD::LOAD_PROFILE:
-            case PWTS::DCMD::BATTERY_STATUS_CHANGED: {
-                if (args.size() < 3)
-                    return false;
-            }
-                break;
+                return true;
             default:
                 break;
         }
 
-        return true;
+        return false;
     }
 
-    void ServiceWorker::parseCMD(const QList<QVariant> &args) {
-        if (!hasValidMessageArgs(args)) {
-            emit logMessageSent(setErrorMsg(QStringLiteral("parseCMD: args is invalid")));
-            emit serviceError();
-            return;
-        }
+    void ServiceWorker::queuePushEvent(const PWTS::DCMD cmd, const QSet<PWTS::DError> &errors, const QString &name) {
+        if (pushEvents->push({.cmd = cmd, .errors = errors, .name = name}))
+            emit pushEventsQueued();
+    }
+
+    // the daemon replies in request order, the oldest pending request of the command is the one answered
+    bool ServiceWorker::matchReply(DaemonFrame &frame, const bool bulkLane) {
+        if (!FrameDecoder::hasValidMessageArgs(frame.args))
+            return true;
 
-        const PWTS::DCMD cmd = static_cast<PWTS::DCMD>(args[0].toInt());
+        PWTS::DCMD cmd = static_cast<PWTS::DCMD>(frame.args[0].toInt());
 
         switch (cmd) {
-            case PWTS::DCMD::PRINT_ERROR: {
-                emit logMessageSent(setErrorMsg(PWTS::getErrorStr(static_cast<PWTS::DError>(args[1].toInt()))));
-                emit commandFailed();
-            }
-                break;
+            case PWTS::DCMD::BATTERY_STATUS_CHANGED:
+            case PWTS::DCMD::SYS_WAKE_FROM_SLEEP:
+            case PWTS::DCMD::APPLY_TIMER:
+                return true;
+            case PWTS::DCMD::PRINT_ERROR:
+                // it does not carry the failed command, it may not answer a request at all
+                return true;
             case PWTS::DCMD::DAEMON_CMD_FAIL:
-                stopTimerForCMD(static_cast<PWTS::DCMD>(args[1].toInt()));
+                cmd = static_cast<PWTS::DCMD>(frame.args[1].toInt());
+                break;
+            default:
                 break;
-            case PWTS::DCMD::GET_DEVICE_INFO_PACKET: {
-                stopTimerForCMD(cmd);
+        }
 
-                if (!args[1].canConvert<PWTS::DeviceInfoPacket>()) {
-                    emit logMessageSent(setErrorMsg(QStringLiteral("Unable to unpack device info packet")));
-                    emit commandFailed();
-                    break;
-                }
+        dropExpiredRequests();
 
-                const PWTS::DeviceInfoPacket packet = args[1].value<PWTS::DeviceInfoPacket>();
+        for (qsizetype i = 0; i < pendingRequests.size(); ++i) {
+            if (pendingRequests[i].cmd != cmd || pendingRequests[i].bulkLane != bulkLane)
+                continue;
 
-                if (packet.error != PWTS::PacketError::NoError) {
-                    emit logMessageSent(PWTS::getPacketErrorStr(packet.error));
-                    emit commandFailed();
-                    break;
+            const PendingRequest req = pendingRequests.takeAt(i);
+
+            if (req.timedOut) {
+                // the daemon applied the change anyway, report what it did
+                if (getCmdPriority(req.cmd) == CmdPriority::Control) {
+                    emit logMessageSent(setErrorMsg(QString("late reply for command: %1").arg(static_cast<int>(req.cmd))));
+                    return true;
                 }
 
-                emit deviceInfoPacketReceived(packet);
+                emit logMessageSent(setErrorMsg(QString("dropped late reply for command: %1").arg(static_cast<int>(req.cmd))));
+                return false;
             }
-                break;
-            case PWTS::DCMD::GET_DAEMON_PACKET: {
-                stopTimerForCMD(cmd);
 
-                if (!args[1].canConvert<PWTS::DaemonPacket>()) {
-                    emit logMessageSent(setErrorMsg(QStringLiteral("Unable to unpack daemon packet")));
-                    emit commandFailed();
-                    break;
-                }
+            const qint64 rttMs = req.sent.elapsed();
+            const double srttMs = rttEstimator.getSmoothedRttMs(req.cmd);
 
-                const PWTS::DaemonPacket packet = args[1].value<PWTS::DaemonPacket>();
+            stopRequestTimer(req.id);
+            frame.requestId = req.id;
 
-                if (packet.error != PWTS::PacketError::NoError) {
-                    emit logMessageSent(PWTS::getPacketErrorStr(packet.error));
-                    emit commandFailed();
-                    break;
-                }
+            // a reply much slower than usual counts as half healthy
+            updateHealthScore(srttMs < 0 || rttMs <= srttMs * 2 ? 1.0 : 0.5);
+            rttEstimator.addSample(req.cmd, rttMs);
+            emit commandLatency(req.cmd, rttMs, hasActiveBulkRequest());
+            return true;
+        }
 
-                emit daemonPacketReceived(packet);
-            }
-                break;
-            case PWTS::DCMD::GET_DAEMON_SETTS: {
-                stopTimerForCMD(cmd);
+        return true;
+    }
+
+    void ServiceWorker::updateHealthScore(const double sample) {
+        healthScore += healthWeight * (sample - healthScore);
+        emit daemonHealthChanged(healthScore);
+    }
+
+    void ServiceWorker::setPrefetchCommands(const QList<PWTS::DCMD> &cmds) {
+        prefetchCmds = cmds;
+    }
 
-                const QByteArray data = args[1].toByteArray();
+    void ServiceWorker::sendPrefetchRequests() {
+        if (prefetchCmds.isEmpty())
+            return;
 
-                if (data.isEmpty()) {
-                    emit logMessageSent(setErrorMsg(QStringLiteral("Unable to get daemon settings")));
-                    emit commandFailed();
+        batchWrites = true;
 
-                } else {
-                    emit daemonSettingsReceived(data);
+        for (const PWTS::DCMD cmd: std::as_const(prefetchCmds)) {
+            switch (cmd) {
+                case PWTS::DCMD::GET_DEVICE_INFO_PACKET:
+                case PWTS::DCMD::GET_DAEMON_PACKET:
+                case PWTS::DCMD::GET_DAEMON_SETTS:
+                case PWTS::DCMD::GET_PROFILE_LIST: {
+                    if (const quint64 reqId = sendCMD(cmd))
+                        pendingPrefetch.insert(reqId);
                 }
+                    break;
+                default:
+                    emit logMessageSent(setErrorMsg(QString("prefetch: unsupported cmd %1").arg(static_cast<int>(cmd))));
+                    break;
             }
-                break;
-            case PWTS::DCMD::APPLY_CLIENT_SETTINGS: {
-                stopTimerForCMD(cmd);
+        }
+
+        batchWrites = false;
+        sock->flush();
+    }
 
-                QSet<PWTS::DError> errors;
+    // a prefetched request completes on its reply, error reply or timeout
+    void ServiceWorker::completePrefetch(const quint64 reqId) {
+        if (!pendingPrefetch.remove(reqId) || !pendingPrefetch.isEmpty())
+            return;
 
-                if (!PWTS::unpackData<QSet<PWTS::DError>>(args[1].toByteArray(), errors)) {
-                    emit logMessageSent(setErrorMsg(QStringLiteral("Unable to get apply settings result")));
-                    emit commandFailed();
+        emit prefetchCompleted(connectTimer.elapsed());
+    }
 
-                } else {
-                    emit currentSettingsApplied(errors);
-                }
-            }
+    void ServiceWorker::dispatchFrame(const DaemonFrame &frame) {
+        if (frame.invalid) {
+            emit logMessageSent(setErrorMsg(frame.error));
+            emit serviceError();
+            return;
+        }
+
+        if (!frame.error.isEmpty()) {
+            profileIndex.abortRequest(getDaemonKey(), frame.requestId);
+            emit logMessageSent(frame.rawError ? frame.error : setErrorMsg(frame.error));
+            emit commandFailed();
+            return;
+        }
+
+        switch (frame.cmd) {
+            case PWTS::DCMD::GET_DEVICE_INFO_PACKET:
+                emit deviceInfoPacketReceived(frame.deviceInfoPacket);
+                break;
+            case PWTS::DCMD::GET_DAEMON_PACKET:
+                emit daemonPacketReceived(frame.daemonPacket);
+                break;
+            case PWTS::DCMD::GET_DAEMON_SETTS:
+                emit daemonSettingsReceived(frame.data);
+                break;
+            case PWTS::DCMD::APPLY_CLIENT_SETTINGS:
+                emit currentSettingsApplied(frame.errors);
+                break;
+            case PWTS::DCMD::DAEMON_CMD_FAIL:
+                profileIndex.endRequest(getDaemonKey(), frame.requestId, false);
                 break;
             case PWTS::DCMD::DELETE_PROFILE: {
-                stopTimerForCMD(cmd);
-                emit profileDeleted(args[1].toBool());
+                profileIndex.endRequest(getDaemonKey(), frame.requestId, frame.result);
+                emit profileDeleted(frame.result);
             }
                 break;
             case PWTS::DCMD::WRITE_PROFILE: {
-                stopTimerForCMD(cmd);
-                emit profileWritten(args[1].toBool());
+                profileIndex.endRequest(getDaemonKey(), frame.requestId, frame.result);
+                emit profileWritten(frame.result);
             }
                 break;
             case PWTS::DCMD::GET_PROFILE_LIST:
-                emit profileListReceived(args[1].toStringList());
+                emit profileListReceived(frame.list);
                 break;
-            case PWTS::DCMD::APPLY_PROFILE: {
-                stopTimerForCMD(cmd);
-
-                QSet<PWTS::DError> errors;
-
-                if (!PWTS::unpackData<QSet<PWTS::DError>>(args[1].toByteArray(), errors)) {
-                    emit logMessageSent(setErrorMsg(QStringLiteral("Unable to get apply profile result")));
-                    emit commandFailed();
-
-                } else {
-                    emit profileApplied(errors, args[2].toString());
-                }
-            }
+            case PWTS::DCMD::APPLY_PROFILE:
+                emit profileApplied(frame.errors, frame.name);
                 break;
             case PWTS::DCMD::LOAD_PROFILE: {
-                stopTimerForCMD(cmd);
-
-                if (!args[1].canConvert<PWTS::DaemonPacket>()) {
-                    emit logMessageSent(setErrorMsg(QStringLiteral("Unable to unpack daemon packet")));
-                    emit commandFailed();
-                    break;
-                }
-
-                emit logMessageSent(QString("Loaded profile: %1").arg(args[2].toString()));
-                emit daemonPacketReceived(args[1].value<PWTS::DaemonPacket>());
+                emit logMessageSent(QString("Loaded profile: %1").arg(frame.name));
+                emit daemonPacketReceived(frame.daemonPacket);
             }
                 break;
             case PWTS::DCMD::EXPORT_PROFILES: {
-                stopTimerForCMD(cmd);
-
-                QHash<QString, QByteArray> exported;
-
-                if (!PWTS::unpackData<QHash<QString, QByteArray>>(args[1].toByteArray(), exported)) {
-                    emit logMessageSent(setErrorMsg(QStringLiteral("Failed to get exported profiles data")));
-                    emit commandFailed();
-
-                } else {
-                    emit profilesExported(exported);
-                }
+                profileIndex.updateFromExport(getDaemonKey(), frame.profiles);
+                emit profilesExported(frame.profiles);
             }
                 break;
             case PWTS::DCMD::IMPORT_PROFILES: {
-                stopTimerForCMD(cmd);
-                emit profilesImported(args[1].toBool());
-            }
-                break;
-            case PWTS::DCMD::APPLY_DAEMON_SETT: {
-                stopTimerForCMD(cmd);
-                emit daemonSettingsApplied(args[1].toBool());
+                profileIndex.endRequest(getDaemonKey(), frame.requestId, frame.result);
+                emit profilesImported(frame.result);
             }
                 break;
-            case PWTS::DCMD::BATTERY_STATUS_CHANGED: {
-                QSet<PWTS::DError> errors;
-
-                if (!PWTS::unpackData<QSet<PWTS::DError>>(args[1].toByteArray(), errors)) {
-                    emit logMessageSent(setErrorMsg(QStringLiteral("Unable to get battery status change event result")));
-                    emit commandFailed();
-
-                } else {
-                    emit batteryStatusChanged(errors, args[2].toString());
-                }
-            }
-                break;
-            case PWTS::DCMD::SYS_WAKE_FROM_SLEEP: {
-                QSet<PWTS::DError> errors;
-
-                if (!PWTS::unpackData<QSet<PWTS::DError>>(args[1].toByteArray(), errors)) {
-                    emit logMessageSent(setErrorMsg(QStringLiteral("Unable to get wake from sleep event result")));
-                    emit commandFailed();
-
-                } else {
-                    emit wakeFromSleepEvent(errors);
-                }
-            }
+            case PWTS::DCMD::APPLY_DAEMON_SETT:
+                emit daemonSettingsApplied(frame.result);
                 break;
-            case PWTS::DCMD::APPLY_TIMER: {
-                QSet<PWTS::DError> errors;
-
-                if (!PWTS::unpackData<QSet<PWTS::DError>>(args[1].toByteArray(), errors)) {
-                    emit logMessageSent(setErrorMsg(QStringLiteral("Unable to get apply timer result")));
-                    emit commandFailed();
-
-                } else {
-                    emit applyTimerTick(errors);
-                }
-            }
+            case PWTS::DCMD::BATTERY_STATUS_CHANGED:
+            case PWTS::DCMD::SYS_WAKE_FROM_SLEEP:
+            case PWTS::DCMD::APPLY_TIMER:
+                queuePushEvent(frame.cmd, frame.errors, frame.name);
                 break;
-            default: {
-                stopTimerForCMD(cmd);
-                emit logMessageSent(setErrorMsg(QString("unknown cmd %1").arg(static_cast<int>(cmd))));
-                emit commandFailed();
-            }
+            default:
                 break;
         }
     }
 
-    void ServiceWorker::sendCMD(const PWTS::DCMD cmd, const QList<QVariant> &args) {
-        QByteArray data;
+    quint64 ServiceWorker::writeCMD(const PWTS::DCMD cmd) {
+        const qsizetype bufferCapacity = encoder.getBuffer().capacity();
 
-        if (!PWTS::packData<QList<QVariant>>(args, data)) {
+        if (!encoder.pack()) {
             emit logMessageSent(setErrorMsg(QString("Failed to send cmd %1").arg(static_cast<int>(cmd))));
             emit commandFailed();
-            return;
+            return 0;
         }
 
-        sock->write(data);
-        sock->flush();
-        startRequestTimer(cmd);
+        if (encoder.getBuffer().capacity() > bufferCapacity)
+            framePool.countSendBufferGrowth();
+
+        QTcpSocket *outSock = getSocketForCMD(cmd);
+
+        outSock->write(encoder.getBuffer());
+        sessionLog.write(SessionLogDirection::Outbound, encoder.getBuffer());
+
+        if (!batchWrites)
+            outSock->flush();
+
+        return startRequest(cmd, outSock == bulkSock);
     }
 
     void ServiceWorker::sendGetDeviceInfoPacketRequest() {
         constexpr PWTS::DCMD cmd = PWTS::DCMD::GET_DEVICE_INFO_PACKET;
-        const QList<QVariant> args {static_cast<int>(cmd)};
 
-        sendCMD(cmd, args);
+        sendCMD(cmd);
     }
 
     void ServiceWorker::sendGetDaemonPacketRequest() {
         constexpr PWTS::DCMD cmd = PWTS::DCMD::GET_DAEMON_PACKET;
-        const QList<QVariant> args {static_cast<int>(cmd)};
 
-        sendCMD(cmd, args);
+        sendCMD(cmd);
     }
 
     void ServiceWorker::sendApplySettingsRequest(const PWTS::ClientPacket &packet) {
         constexpr PWTS::DCMD cmd = PWTS::DCMD::APPLY_CLIENT_SETTINGS;
-        const QList<QVariant> args {static_cast<int>(cmd), QVariant::fromValue<PWTS::ClientPacket>(packet)};
 
-        sendCMD(cmd, args);
+        sendCMD(cmd, packet);
     }
 
     void ServiceWorker::sendGetDaemonSettingsRequest() {
         constexpr PWTS::DCMD cmd = PWTS::DCMD::GET_DAEMON_SETTS;
-        const QList<QVariant> args {static_cast<int>(cmd)};
 
-        sendCMD(cmd, args);
+        sendCMD(cmd);
     }
 
     void ServiceWorker::sendGetProfileListRequest() {
         constexpr PWTS::DCMD cmd = PWTS::DCMD::GET_PROFILE_LIST;
-        const QList<QVariant> args {static_cast<int>(cmd)};
 
-        sendCMD(cmd, args);
+        sendCMD(cmd);
     }
 
     void ServiceWorker::sendDeleteProfileRequest(const QString &name) {
         constexpr PWTS::DCMD cmd = PWTS::DCMD::DELETE_PROFILE;
-        const QList<QVariant> args {static_cast<int>(cmd), name};
 
-        sendCMD(cmd, args);
+        if (const quint64 reqId = sendCMD(cmd, name))
+            profileIndex.beginDelete(reqId, name);
     }
 
     void ServiceWorker::sendWriteProfileRequest(const QString &name, const PWTS::ClientPacket &packet) {
         constexpr PWTS::DCMD cmd = PWTS::DCMD::WRITE_PROFILE;
-        const QList<QVariant> args {static_cast<int>(cmd), name, QVariant::fromValue<PWTS::ClientPacket>(packet)};
 
-        sendCMD(cmd, args);
+        if (const quint64 reqId = sendCMD(cmd, name, packet))
+            profileIndex.beginWrite(reqId, name);
     }
 
     void ServiceWorker::sendLoadProfileRequest(const QString &name) {
         constexpr PWTS::DCMD cmd = PWTS::DCMD::LOAD_PROFILE;
-        const QList<QVariant> args {static_cast<int>(cmd), name};
 
-        sendCMD(cmd, args);
+        sendCMD(cmd, name);
     }
 
     void ServiceWorker::sendApplyProfileRequest(const QString &name) {
         constexpr PWTS::DCMD cmd = PWTS::DCMD::APPLY_PROFILE;
-        const QList<QVariant> args {static_cast<int>(cmd), name};
 
-        sendCMD(cmd, args);
+        sendCMD(cmd, name);
     }
 
     void ServiceWorker::sendExportProfilesRequest(const QString &name) {
         constexpr PWTS::DCMD cmd = PWTS::DCMD::EXPORT_PROFILES;
-        const QList<QVariant> args {static_cast<int>(cmd), name};
 
-        sendCMD(cmd, args);
+        sendCMD(cmd, name);
     }
 
     void ServiceWorker::sendImportProfilesRequest(const QHash<QString, QByteArray> &profiles) {
         constexpr PWTS::DCMD cmd = PWTS::DCMD::IMPORT_PROFILES;
         QByteArray profilesData;
-        QList<QVariant> args;
 
         if (!PWTS::packData<QHash<QString, QByteArray>>(profiles, profilesData)) {
             emit logMessageSent(setErrorMsg("Import profiles: failed to pack profiles data for send"));
@@ -432,21 +514,36 @@ namespace PWTCS {
             return;
         }
 
-        args.append(static_cast<int>(cmd));
-        args.append(profilesData);
+        if (const quint64 reqId = sendCMD(cmd, profilesData))
+            profileIndex.beginImport(reqId, profiles);
+    }
+
+    void ServiceWorker::sendSyncProfilesRequest(const QHash<QString, QByteArray> &profiles) {
+        const QHash<QString, QByteArray> changed = profileIndex.getChangedProfiles(getDaemonKey(), profiles);
+
+        emit logMessageSent(setErrorMsg(QString("Profile sync: %1 changed, %2 unchanged").arg(changed.size()).arg(profiles.size() - changed.size())));
+
+        if (changed.isEmpty()) {
+            emit profilesImported(true);
+            return;
+        }
+
+        sendImportProfilesRequest(changed);
+    }
 
-        sendCMD(cmd, args);
+    void ServiceWorker::clearProfileSyncState() {
+        profileIndex.clear();
     }
 
     void ServiceWorker::sendApplyDaemonSettingsRequest(const QByteArray &data) {
         constexpr PWTS::DCMD cmd = PWTS::DCMD::APPLY_DAEMON_SETT;
-        const QList<QVariant> args {static_cast<int>(cmd), data};
 
-        sendCMD(cmd, args);
+        sendCMD(cmd, data);
     }
 
     void ServiceWorker::onConnected() {
         emit serviceConnected(saddr, sport);
+        sendPrefetchRequests();
     }
 
     void ServiceWorker::onDisconnected() {
@@ -456,24 +553,129 @@ namespace PWTCS {
         emit serviceDisconnected();
     }
 
-    void ServiceWorker::onReadyRead() {
-        QList<QVariant> args;
+    // frames still in the reader for the previous connection are dropped when they come back
+    void ServiceWorker::resetFrameLane(const bool bulkLane) {
+        FrameLane &lane = getFrameLane(bulkLane);
 
-        while (true) {
-            sockStreamIn.startTransaction();
-            sockStreamIn >> args;
+        lane = {.epoch = lane.epoch + 1};
+    }
 
-            if (!sockStreamIn.commitTransaction())
-                break;
+    // only moves bytes to the reader, the read buffer cap also bounds the bytes waiting to be read there
+    void ServiceWorker::readSocket(QTcpSocket *socket, const bool bulkLane) {
+        const FrameLane &lane = getFrameLane(bulkLane);
+        qint64 size = socket->bytesAvailable();
 
-            if (args.isEmpty()) {
-                emit logMessageSent(setErrorMsg(QStringLiteral("Failed to get data from daemon")));
-                emit commandFailed();
-                break;
-            }
+        if (readBufferSize > 0) {
+            // a frame larger than the cap can only be completed past it, up to the max frame size
+            const qint64 limit = lane.pendingBytes < readBufferSize ? readBufferSize : maxFrameSize;
+
+            if (limit > 0)
+                size = qMin(size, limit - lane.queuedBytes - lane.pendingBytes);
+        }
+
+        if (size > 0)
+            appendInbound(bulkLane, socket->read(size));
+    }
+
+    void ServiceWorker::appendInbound(const bool bulkLane, const QByteArray &data) {
+        FrameLane &lane = getFrameLane(bulkLane);
+        const quint64 epoch = lane.epoch;
+        const bool capture = sessionLog.isOpen();
+
+        lane.queuedBytes += data.size();
+        QMetaObject::invokeMethod(frameReader, [reader = frameReader, epoch, bulkLane, data, capture] { reader->appendData(epoch, bulkLane, data, capture); }, Qt::QueuedConnection);
+    }
+
+    void ServiceWorker::handleFrame(DaemonFrame *frame, const bool bulkLane) {
+        if (!frame->raw.isEmpty())
+            sessionLog.write(SessionLogDirection::Inbound, frame->raw);
+
+        if (frame->args.isEmpty()) {
+            framePool.release(frame);
+            emit logMessageSent(setErrorMsg(QStringLiteral("Failed to get data from daemon")));
+            emit commandFailed();
+            return;
+        }
+
+        // the daemon broadcasts push events to every connection, they are already received on the main one
+        if ((!bulkLane || !isPushEvent(frame->args)) && matchReply(*frame, bulkLane)) {
+            dispatchFrame(*frame);
+            completePrefetch(frame->requestId);
+            emit frameProcessed(frame->cmd, frame->received.nsecsElapsed());
+        }
+
+        framePool.release(frame);
+    }
+
+    // its size is only known once it is complete, a corrupt length would grow the buffer without bound
+    void ServiceWorker::dropOversizedFrame(const bool bulkLane) {
+        const QString connection = bulkLane ? QStringLiteral("bulk connection") : QStringLiteral("connection");
+
+        emit logMessageSent(setErrorMsg(QString("Frame larger than %1 bytes, closing %2").arg(maxFrameSize).arg(connection)));
+
+        if (bulkLane) {
+            abortBulkSocket();
+            failBulkRequests();
+            return;
+        }
+
+        if (!disconnect())
+            emit logMessageSent(setErrorMsg(QStringLiteral("Failed to close connection on error")));
+
+        emit serviceError();
+    }
+
+    void ServiceWorker::onFramesRead(const quint64 epoch, const bool bulkLane, const QList<DaemonFrame *> &frames, const qint64 appended, const qint64 pending) {
+        FrameLane &lane = getFrameLane(bulkLane);
+
+        if (epoch == lane.epoch) {
+            lane.queuedBytes -= appended;
+            lane.pendingBytes = pending;
+
+            for (DaemonFrame *frame: frames)
+                handleFrame(frame, bulkLane);
 
-            parseCMD(args);
+            // or resume reads held back by the cap
+            if (maxFrameSize > 0 && pending >= maxFrameSize)
+                dropOversizedFrame(bulkLane);
+            else
+                readSocket(bulkLane ? bulkSock : sock, bulkLane);
+
+        } else {
+            for (DaemonFrame *frame: frames)
+                framePool.release(frame);
         }
+
+        if (lane.queuedBytes == 0)
+            emit inboundProcessed();
+    }
+
+    // fed as received on the main connection
+    void ServiceWorker::replayInbound(const QByteArray &data) {
+        appendInbound(false, data);
+    }
+
+    void ServiceWorker::startCapture(const QString &path) {
+        if (!sessionLog.open(path))
+            emit logMessageSent(QString("Failed to open session capture file %1").arg(path));
+    }
+
+    void ServiceWorker::stopCapture() {
+        sessionLog.close();
+    }
+
+    void ServiceWorker::onReadyRead() {
+        readSocket(sock, false);
+    }
+
+    void ServiceWorker::onBulkReadyRead() {
+        readSocket(bulkSock, true);
+    }
+
+    void ServiceWorker::onBulkErrorOccurred(const QAbstractSocket::SocketError) {
+        emit logMessageSent(setErrorMsg(QString("Bulk connection error, falling back to main connection: %1").arg(bulkSock->errorString())));
+        abortBulkSocket();
+        failBulkRequests();
     }
 
     void ServiceWorker::onErrorOccurred(const QAbstractSocket::SocketError error) {
@@ -501,8 +703,30 @@ namespace PWTCS {
         emit serviceError();
     }
 
-    void ServiceWorker::onCommandTimeout(const QString &sockAddr, const PWTS::DCMD cmd) {
+    void ServiceWorker::onCommandTimeout(const QString &sockAddr, const PWTS::DCMD cmd, const quint64 reqId) {
         emit logMessageSent(QString("[%1]: request timeout for command: %2").arg(sockAddr).arg(static_cast<int>(cmd)));
+
+        if (sockAddr == saddr) {
+            dropExpiredRequests();
+
+            // keep it queued, its reply may still come and must not be taken by a newer request
+            for (PendingRequest &req: pendingRequests) {
+                if (req.id != reqId)
+                    continue;
+
+                req.timedOut = true;
+                req.lateReplyDeadline.setRemainingTime(lateReplyWindowMs);
+                break;
+            }
+
+            profileIndex.abortRequest(getDaemonKey(), reqId);
+            rttEstimator.backoff(cmd);
+            updateHealthScore(0);
+        }
+
         emit commandFailed();
+
+        if (sockAddr == saddr)
+            completePrefetch(reqId);
     }
 }
@@ -18,49 +18,137 @@
 #pragma once
 
 #include <QTcpSocket>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QDeadlineTimer>
 
 #include "pwtShared/Include/Packets/DeviceInfoPacket.h"
 #include "pwtShared/Include/Packets/ClientPacket.h"
 #include "pwtShared/Include/Packets/DaemonPacket.h"
 #include "pwtShared/Include/DaemonCMD.h"
 #include "ClientServiceCmdTimer.h"
+#include "PushEventQueue.h"
+#include "DaemonFramePool.h"
+#include "FrameReader.h"
+#include "SessionLog.h"
+#include "CmdPriority.h"
+#include "ProfileSyncIndex.h"
+#include "CommandRttEstimator.h"
 
 namespace PWTCS {
     class ServiceWorker final: public QObject {
         Q_OBJECT
 
     private:
+        static constexpr double healthWeight = 0.2;
+        static constexpr qint64 defaultMaxFrameSize = 64 * 1024 * 1024;
+        static constexpr qint64 lateReplyWindowMs = 120 * 1000;
+
+        struct PendingRequest final {
+            quint64 id;
+            PWTS::DCMD cmd;
+            bool bulkLane;
+            bool timedOut = false;
+            QElapsedTimer sent;
+            QDeadlineTimer lateReplyDeadline;
+        };
+
+        // bytes of one connection handed to the reader, frames of an older epoch were read before a reset
+        struct FrameLane final {
+            quint64 epoch = 0;
+            qint64 queuedBytes = 0;
+            qint64 pendingBytes = 0;
+        };
+
         QTcpSocket *sock = nullptr;
+        QTcpSocket *bulkSock = nullptr;
+        PushEventQueue *pushEvents;
         QList<ClientServiceCmdTimer *> reqTimerPool;
-        QDataStream sockStreamIn;
+        QList<PendingRequest> pendingRequests;
+        quint64 nextRequestId = 1;
         QString saddr;
-        quint16 sport;
+        quint16 sport = 0;
+        qint64 readBufferSize = 0;
+        qint64 maxFrameSize = defaultMaxFrameSize;
+        bool bulkLaneEnabled = false;
+        DaemonFramePool framePool;
+        QThread *readerThread = nullptr;
+        FrameReader *frameReader = nullptr;
+        FrameLane mainFrameLane;
+        FrameLane bulkFrameLane;
+        FrameEncoder encoder;
+        QList<PWTS::DCMD> prefetchCmds;
+        QSet<quint64> pendingPrefetch;
+        QElapsedTimer connectTimer;
+        bool batchWrites = false;
+        SessionLogWriter sessionLog;
+        ProfileSyncIndex profileIndex;
+        CommandRttEstimator rttEstimator;
+        double healthScore = 1;
 
         [[nodiscard]] QString setErrorMsg(const QString &msg) const { return QString("[%1]: %2").arg(saddr, msg); }
+        [[nodiscard]] QString getDaemonKey() const { return QString("%1:%2").arg(saddr).arg(sport); }
+        [[nodiscard]] FrameLane &getFrameLane(const bool bulkLane) { return bulkLane ? bulkFrameLane : mainFrameLane; }
 
-        void abortSocket() const;
-        [[nodiscard]] bool disconnect() const;
-        [[nodiscard]] bool hasValidMessageArgs(const QList<QVariant> &args) const;
-        void parseCMD(const QList<QVariant> &args);
-        void sendCMD(PWTS::DCMD cmd, const QList<QVariant> &args);
-        void startRequestTimer(PWTS::DCMD cmd);
+        void abortSocket();
+        void abortBulkSocket();
+        [[nodiscard]] QTcpSocket *getSocketForCMD(PWTS::DCMD cmd) const;
+        [[nodiscard]] bool hasActiveBulkRequest() const;
+        [[nodiscard]] static bool isPushEvent(const QList<QVariant> &args);
+        [[nodiscard]] bool disconnect();
+        [[nodiscard]] bool matchReply(DaemonFrame &frame, bool bulkLane);
+        void clearPendingRequests();
+        void failBulkRequests();
+        void dropExpiredRequests();
+        void resetFrameLane(bool bulkLane);
+        void readSocket(QTcpSocket *socket, bool bulkLane);
+        void appendInbound(bool bulkLane, const QByteArray &data);
+        void handleFrame(DaemonFrame *frame, bool bulkLane);
+        void dropOversizedFrame(bool bulkLane);
+        void dispatchFrame(const DaemonFrame &frame);
+        void sendPrefetchRequests();
+        void completePrefetch(quint64 reqId);
+        void updateHealthScore(double sample);
+        quint64 writeCMD(PWTS::DCMD cmd);
+        quint64 startRequest(PWTS::DCMD cmd, bool bulkLane);
         void stopAllTimers() const;
-        void stopTimerForCMD(PWTS::DCMD cmd) const;
+        void stopRequestTimer(quint64 reqId) const;
+        void queuePushEvent(PWTS::DCMD cmd, const QSet<PWTS::DError> &errors, const QString &name = {});
+
+        // returns the request id, 0 when the command could not be sent
+        template <typename... Args>
+        quint64 sendCMD(const PWTS::DCMD cmd, const Args &...args) {
+            encoder.setArgs(cmd, args...);
+            return writeCMD(cmd);
+        }
 
     public:
+        explicit ServiceWorker(PushEventQueue *pushQueue): pushEvents(pushQueue) {}
         ~ServiceWorker() override;
 
+        [[nodiscard]] FrameAllocStats getFrameAllocStats() const { return framePool.getStats(); }
+
     private slots:
         void onConnected();
         void onDisconnected();
         void onReadyRead();
+        void onBulkReadyRead();
+        void onBulkErrorOccurred(QAbstractSocket::SocketError error);
         void onErrorOccurred(QAbstractSocket::SocketError error);
-        void onCommandTimeout(const QString &sockAddr, PWTS::DCMD cmd);
+        void onCommandTimeout(const QString &sockAddr, PWTS::DCMD cmd, quint64 reqId);
+        void onFramesRead(quint64 epoch, bool bulkLane, const QList<PWTCS::DaemonFrame *> &frames, qint64 appended, qint64 pending);
 
     public slots:
         void init();
         void disconnectFromDaemon();
         void connectToDaemon(const QString &adr, quint16 port);
+        void setReadBufferSize(qint64 size);
+        void setMaxFrameSize(qint64 size);
+        void setBulkLaneEnabled(bool enable);
+        void setPrefetchCommands(const QList<PWTS::DCMD> &cmds);
+        void startCapture(const QString &path);
+        void stopCapture();
+        void replayInbound(const QByteArray &data);
         void sendGetDeviceInfoPacketRequest();
         void sendGetDaemonPacketRequest();
         void sendApplySettingsRequest(const PWTS::ClientPacket &packet);
@@ -73,20 +161,25 @@ namespace PWTCS {
         void sendExportProfilesRequest(const QString &name);
         void sendImportProfilesRequest(const QHash<QString, QByteArray> &profiles);
         void sendApplyDaemonSettingsRequest(const QByteArray &data);
+        void sendSyncProfilesRequest(const QHash<QString, QByteArray> &profiles);
+        void clearProfileSyncState();
 
     signals:
         void logMessageSent(const QString &msg);
         void serviceError();
         void serviceConnected(const QString &adr, quint16 port);
+        void prefetchCompleted(qint64 elapsedMs);
         void serviceDisconnected();
         void commandFailed();
         void deviceInfoPacketReceived(const PWTS::DeviceInfoPacket &packet);
         void daemonPacketReceived(const PWTS::DaemonPacket &packet);
         void currentSettingsApplied(const QSet<PWTS::DError> &errors);
         void daemonSettingsApplied(bool success);
-        void batteryStatusChanged(const QSet<PWTS::DError> &errors, const QString &name);
-        void wakeFromSleepEvent(const QSet<PWTS::DError> &errors);
-        void applyTimerTick(const QSet<PWTS::DError> &errors);
+        void pushEventsQueued();
+        void frameProcessed(PWTS::DCMD cmd, qint64 elapsedNs);
+        void inboundProcessed();
+        void commandLatency(PWTS::DCMD cmd, qint64 rttMs, bool duringBulkTransfer);
+        void daemonHealthChanged(double score);
         void daemonSettingsReceived(const QByteArray &data);
         void profileApplied(const QSet<PWTS::DError> &errors, const QString &name);
         void profileListReceived(const QList<QString> &list);
@@ -0,0 +1,81 @@
+/*
+ * This file is part of PWTClientService.
+ * Copyright (C) 2025 kylon
+ *
+ * PWTClientService is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PWTClientService is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "SessionLog.h"
+
+namespace PWTCS {
+    static constexpr quint32 sessionLogMagic = 0x50575452;
+    static constexpr quint16 sessionLogVersion = 1;
+
+    bool SessionLogWriter::open(const QString &path) {
+        close();
+        file.setFileName(path);
+
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+            return false;
+
+        ds.setDevice(&file);
+        ds.setVersion(QDataStream::Qt_6_0);
+        ds << sessionLogMagic << sessionLogVersion;
+        clock.start();
+
+        return ds.status() == QDataStream::Ok;
+    }
+
+    void SessionLogWriter::close() {
+        if (!file.isOpen())
+            return;
+
+        ds.setDevice(nullptr);
+        file.close();
+    }
+
+    void SessionLogWriter::write(const SessionLogDirection direction, const QByteArray &frame) {
+        if (!file.isOpen())
+            return;
+
+        ds << static_cast<quint8>(direction) << clock.nsecsElapsed() << frame;
+    }
+
+    bool SessionLogReader::open(const QString &path) {
+        quint32 magic;
+        quint16 version;
+
+        file.setFileName(path);
+
+        if (!file.open(QIODevice::ReadOnly))
+            return false;
+
+        ds.setDevice(&file);
+        ds.setVersion(QDataStream::Qt_6_0);
+        ds >> magic >> version;
+
+        return ds.status() == QDataStream::Ok && magic == sessionLogMagic && version == sessionLogVersion;
+    }
+
+    bool SessionLogReader::next(SessionLogRecord &record) {
+        quint8 direction;
+
+        if (ds.atEnd())
+            return false;
+
+        ds >> direction >> record.timestampNs >> record.frame;
+        record.direction = static_cast<SessionLogDirection>(direction);
+
+        return ds.status() == QDataStream::Ok && direction <= static_cast<quint8>(SessionLogDirection::Outbound);
+    }
+}
@@ -0,0 +1,63 @@
+/*
+ * This file is part of PWTClientService.
+ * Copyright (C) 2025 kylon
+ *
+ * PWTClientService is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PWTClientService is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QElapsedTimer>
+#include <QDataStream>
+#include <QFile>
+
+namespace PWTCS {
+    enum class SessionLogDirection: quint8 {
+        Inbound,
+        Outbound
+    };
+
+    struct SessionLogRecord final {
+        SessionLogDirection direction;
+        qint64 timestampNs;
+        QByteArray frame;
+    };
+
+    /*
+     * Binary log of the raw frames exchanged with a daemon.
+     * Layout: magic, version, then one record per frame: direction, ns since start, frame bytes.
+     */
+    class SessionLogWriter final {
+    private:
+        QFile file;
+        QDataStream ds;
+        QElapsedTimer clock;
+
+    public:
+        [[nodiscard]] bool isOpen() const { return file.isOpen(); }
+
+        [[nodiscard]] bool open(const QString &path);
+        void close();
+        void write(SessionLogDirection direction, const QByteArray &frame);
+    };
+
+    class SessionLogReader final {
+    private:
+        QFile file;
+        QDataStream ds;
+
+    public:
+        [[nodiscard]] bool open(const QString &path);
+        [[nodiscard]] bool next(SessionLogRecord &record);
+    };
+}
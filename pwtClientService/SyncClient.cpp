@@ -0,0 +1,253 @@
+/*
+ * This file is part of PWTClientService.
+ * Copyright (C) 2025 kylon
+ *
+ * PWTClientService is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PWTClientService is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <QTcpSocket>
+
+#include "SyncClient.h"
+#include "pwtShared/Utils.h"
+
+namespace PWTCS {
+    SyncClient::SyncClient() {
+        FrameDecoder::registerTypes();
+
+        sock = new QTcpSocket();
+
+        sockStreamIn.setDevice(sock);
+    }
+
+    SyncClient::~SyncClient() {
+        disconnectFromDaemon();
+        delete sock;
+    }
+
+    bool SyncClient::setError(const QString &msg) {
+        lastError = QString("[%1]: %2").arg(saddr, msg);
+        return false;
+    }
+
+    bool SyncClient::isConnected() const {
+        return sock->state() == QAbstractSocket::ConnectedState;
+    }
+
+    bool SyncClient::connectToDaemon(const QString &adr, const quint16 port) {
+        disconnectFromDaemon();
+
+        saddr = adr;
+        sport = port;
+        sock->connectToHost(QHostAddress(adr), port);
+
+        if (!sock->waitForConnected(timeoutMs))
+            return setError(sock->errorString());
+
+        return true;
+    }
+
+    void SyncClient::disconnectFromDaemon() {
+        reconnectPending = false;
+
+        if (sock->state() != QAbstractSocket::UnconnectedState)
+            sock->abort();
+
+        sock->close();
+        sockStreamIn.resetStatus();
+    }
+
+    // the reply of the failed request may still be in flight or half read, the next request must not take it
+    bool SyncClient::dropConnection(const QString &msg) {
+        disconnectFromDaemon();
+        reconnectPending = true;
+        return setError(msg);
+    }
+
+    bool SyncClient::reconnect(const QDeadlineTimer &deadline) {
+        disconnectFromDaemon();
+        sock->connectToHost(QHostAddress(saddr), sport);
+
+        if (!sock->waitForConnected(static_cast<int>(deadline.remainingTime())))
+            return setError(sock->errorString());
+
+        return true;
+    }
+
+    bool SyncClient::writeCMD(const PWTS::DCMD cmd, const QDeadlineTimer &deadline) {
+        if (reconnectPending && !reconnect(deadline))
+            return false;
+
+        if (!isConnected())
+            return setError(QStringLiteral("Not connected"));
+
+        if (!encoder.pack())
+            return setError(QString("Failed to send cmd %1").arg(static_cast<int>(cmd)));
+
+        sock->write(encoder.getBuffer());
+
+        while (sock->bytesToWrite() > 0) {
+            if (!sock->waitForBytesWritten(static_cast<int>(deadline.remainingTime())))
+                return setError(QString("Failed to send cmd %1: %2").arg(static_cast<int>(cmd)).arg(sock->errorString()));
+        }
+
+        return true;
+    }
+
+    bool SyncClient::waitReply(const PWTS::DCMD cmd, const QDeadlineTimer &deadline) {
+        while (true) {
+            frame.reset();
+
+            if (!FrameDecoder::readFrame(sockStreamIn, frame.args)) {
+                if (!sock->waitForReadyRead(static_cast<int>(deadline.remainingTime()))) {
+                    if (deadline.hasExpired())
+                        return dropConnection(QString("request timeout for command: %1").arg(static_cast<int>(cmd)));
+
+                    return setError(sock->errorString());
+                }
+
+                continue;
+            }
+
+            if (frame.args.isEmpty())
+                return dropConnection(QStringLiteral("Failed to get data from daemon"));
+
+            FrameDecoder::decode(frame);
+
+            if (frame.invalid)
+                return dropConnection(frame.error);
+
+            switch (frame.cmd) {
+                case PWTS::DCMD::BATTERY_STATUS_CHANGED:
+                case PWTS::DCMD::SYS_WAKE_FROM_SLEEP:
+                case PWTS::DCMD::APPLY_TIMER:
+                    continue;
+                case PWTS::DCMD::PRINT_ERROR:
+                    return setError(frame.error);
+                case PWTS::DCMD::DAEMON_CMD_FAIL: {
+                    if (frame.failedCmd == cmd)
+                        return setError(QString("daemon failed to run command: %1").arg(static_cast<int>(cmd)));
+                }
+                    continue;
+                default:
+                    break;
+            }
+
+            // not a reply to this request
+            if (frame.cmd != cmd)
+                continue;
+
+            if (!frame.error.isEmpty()) {
+                if (frame.rawError)
+                    lastError = frame.error;
+                else
+                    setError(frame.error);
+
+                return false;
+            }
+
+            return true;
+        }
+    }
+
+    bool SyncClient::checkResult() {
+        if (!frame.result)
+            return setError(QString("daemon reported failure for command: %1").arg(static_cast<int>(frame.cmd)));
+
+        return true;
+    }
+
+    bool SyncClient::getDeviceInfoPacket(PWTS::DeviceInfoPacket &packet) {
+        if (!request(PWTS::DCMD::GET_DEVICE_INFO_PACKET))
+            return false;
+
+        packet = frame.deviceInfoPacket;
+        return true;
+    }
+
+    bool SyncClient::getDaemonPacket(PWTS::DaemonPacket &packet) {
+        if (!request(PWTS::DCMD::GET_DAEMON_PACKET))
+            return false;
+
+        packet = frame.daemonPacket;
+        return true;
+    }
+
+    bool SyncClient::applySettings(const PWTS::ClientPacket &packet, QSet<PWTS::DError> &errors) {
+        if (!request(PWTS::DCMD::APPLY_CLIENT_SETTINGS, packet))
+            return false;
+
+        errors = frame.errors;
+        return true;
+    }
+
+    bool SyncClient::getDaemonSettings(QByteArray &data) {
+        if (!request(PWTS::DCMD::GET_DAEMON_SETTS))
+            return false;
+
+        data = frame.data;
+        return true;
+    }
+
+    bool SyncClient::applyDaemonSettings(const QByteArray &data) {
+        return request(PWTS::DCMD::APPLY_DAEMON_SETT, data) && checkResult();
+    }
+
+    bool SyncClient::getProfileList(QList<QString> &list) {
+        if (!request(PWTS::DCMD::GET_PROFILE_LIST))
+            return false;
+
+        list = frame.list;
+        return true;
+    }
+
+    bool SyncClient::deleteProfile(const QString &name) {
+        return request(PWTS::DCMD::DELETE_PROFILE, name) && checkResult();
+    }
+
+    bool SyncClient::writeProfile(const QString &name, const PWTS::ClientPacket &packet) {
+        return request(PWTS::DCMD::WRITE_PROFILE, name, packet) && checkResult();
+    }
+
+    bool SyncClient::loadProfile(const QString &name, PWTS::DaemonPacket &packet) {
+        if (!request(PWTS::DCMD::LOAD_PROFILE, name))
+            return false;
+
+        packet = frame.daemonPacket;
+        return true;
+    }
+
+    bool SyncClient::applyProfile(const QString &name, QSet<PWTS::DError> &errors) {
+        if (!request(PWTS::DCMD::APPLY_PROFILE, name))
+            return false;
+
+        errors = frame.errors;
+        return true;
+    }
+
+    bool SyncClient::exportProfiles(const QString &name, QHash<QString, QByteArray> &profiles) {
+        if (!request(PWTS::DCMD::EXPORT_PROFILES, name))
+            return false;
+
+        profiles = frame.profiles;
+        return true;
+    }
+
+    bool SyncClient::importProfiles(const QHash<QString, QByteArray> &profiles) {
+        QByteArray profilesData;
+
+        if (!PWTS::packData<QHash<QString, QByteArray>>(profiles, profilesData))
+            return setError(QStringLiteral("Import profiles: failed to pack profiles data for send"));
+
+        return request(PWTS::DCMD::IMPORT_PROFILES, profilesData) && checkResult();
+    }
+}
@@ -0,0 +1,90 @@
+/*
+ * This file is part of PWTClientService.
+ * Copyright (C) 2025 kylon
+ *
+ * PWTClientService is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PWTClientService is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <QDeadlineTimer>
+
+#include "serviceExport.h"
+#include "FrameDecoder.h"
+#include "pwtShared/Include/Packets/ClientPacket.h"
+
+class QTcpSocket;
+
+namespace PWTCS {
+    /*
+     * Blocking client for CLI tools and scripts.
+     * Runs on the caller thread without an event loop, one request at a time.
+     * Push events received while waiting for a reply are discarded.
+     * A request that times out or gets a malformed reply drops the connection, the next request reconnects.
+     */
+    class PWTCSERVICE_EXPORT SyncClient final {
+    private:
+        static constexpr int defaultTimeoutMs = 30 * 1000;
+        QTcpSocket *sock;
+        QDataStream sockStreamIn;
+        FrameEncoder encoder;
+        DaemonFrame frame;
+        QString saddr;
+        quint16 sport = 0;
+        bool reconnectPending = false;
+        QString lastError;
+        int timeoutMs = defaultTimeoutMs;
+
+        bool setError(const QString &msg);
+        bool dropConnection(const QString &msg);
+        [[nodiscard]] bool reconnect(const QDeadlineTimer &deadline);
+        [[nodiscard]] bool writeCMD(PWTS::DCMD cmd, const QDeadlineTimer &deadline);
+        [[nodiscard]] bool waitReply(PWTS::DCMD cmd, const QDeadlineTimer &deadline);
+        [[nodiscard]] bool checkResult();
+
+        template <typename... Args>
+        [[nodiscard]] bool request(const PWTS::DCMD cmd, const Args &...args) {
+            const QDeadlineTimer deadline {timeoutMs};
+
+            encoder.setArgs(cmd, args...);
+            return writeCMD(cmd, deadline) && waitReply(cmd, deadline);
+        }
+
+    public:
+        SyncClient();
+        ~SyncClient();
+
+        SyncClient(const SyncClient &) = delete;
+        SyncClient &operator=(const SyncClient &) = delete;
+
+        [[nodiscard]] QString getLastError() const { return lastError; }
+        [[nodiscard]] int getTimeout() const { return timeoutMs; }
+        void setTimeout(const int ms) { timeoutMs = ms; }
+        [[nodiscard]] bool isConnected() const;
+
+        [[nodiscard]] bool connectToDaemon(const QString &adr, quint16 port);
+        void disconnectFromDaemon();
+        [[nodiscard]] bool getDeviceInfoPacket(PWTS::DeviceInfoPacket &packet);
+        [[nodiscard]] bool getDaemonPacket(PWTS::DaemonPacket &packet);
+        [[nodiscard]] bool applySettings(const PWTS::ClientPacket &packet, QSet<PWTS::DError> &errors);
+        [[nodiscard]] bool getDaemonSettings(QByteArray &data);
+        [[nodiscard]] bool applyDaemonSettings(const QByteArray &data);
+        [[nodiscard]] bool getProfileList(QList<QString> &list);
+        [[nodiscard]] bool deleteProfile(const QString &name);
+        [[nodiscard]] bool writeProfile(const QString &name, const PWTS::ClientPacket &packet);
+        [[nodiscard]] bool loadProfile(const QString &name, PWTS::DaemonPacket &packet);
+        [[nodiscard]] bool applyProfile(const QString &name, QSet<PWTS::DError> &errors);
+        [[nodiscard]] bool exportProfiles(const QString &name, QHash<QString, QByteArray> &profiles);
+        [[nodiscard]] bool importProfiles(const QHash<QString, QByteArray> &profiles);
+    };
+}
@@ -0,0 +1,207 @@
+/*
+ * This file is part of PWTClientService.
+ * Copyright (C) 2025 kylon
+ *
+ * PWTClientService is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PWTClientService is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QFile>
+#include <QDir>
+
+#include <cstdlib>
+#include <atomic>
+
+#include "pwtClientService/DaemonFramePool.h"
+#include "pwtShared/Utils.h"
+
+namespace {
+    std::atomic<quint64> heapAllocs = 0;
+
+    // -1 when heap allocations cannot be counted on this platform
+    [[nodiscard]] qint64 getHeapAllocCount() {
+#if defined(__GLIBC__)
+        return static_cast<qint64>(heapAllocs.load(std::memory_order_relaxed));
+#else
+        return -1;
+#endif
+    }
+}
+
+#if defined(__GLIBC__)
+// Qt containers allocate through malloc, not operator new, so count at the libc level
+extern "C" {
+    void *__libc_malloc(size_t size);
+    void *__libc_calloc(size_t count, size_t size);
+    void *__libc_realloc(void *ptr, size_t size);
+
+    void *malloc(const size_t size) noexcept {
+        heapAllocs.fetch_add(1, std::memory_order_relaxed);
+        return __libc_malloc(size);
+    }
+
+    void *calloc(const size_t count, const size_t size) noexcept {
+        heapAllocs.fetch_add(1, std::memory_order_relaxed);
+        return __libc_calloc(count, size);
+    }
+
+    void *realloc(void *ptr, const size_t size) noexcept {
+        heapAllocs.fetch_add(1, std::memory_order_relaxed);
+        return __libc_realloc(ptr, size);
+    }
+}
+#endif
+
+namespace {
+    struct BenchFrame final {
+        QString label;
+        QByteArray data;
+    };
+
+    [[nodiscard]] QByteArray packErrors(const QSet<PWTS::DError> &errors) {
+        QByteArray data;
+
+        if (!PWTS::packData<QSet<PWTS::DError>>(errors, data))
+            qFatal("failed to pack errors");
+
+        return data;
+    }
+
+    [[nodiscard]] BenchFrame makeFrame(const QString &label, const QList<QVariant> &args) {
+        BenchFrame frame {.label = label};
+
+        if (!PWTS::packData<QList<QVariant>>(args, frame.data))
+            qFatal("failed to pack frame %s", qPrintable(label));
+
+        return frame;
+    }
+
+    [[nodiscard]] QList<BenchFrame> makeFrames(const int profileCount, const int profileSize) {
+        const QSet<PWTS::DError> errors {static_cast<PWTS::DError>(1), static_cast<PWTS::DError>(2)};
+        QHash<QString, QByteArray> profiles;
+        QByteArray profilesData;
+        QList<QString> profileNames;
+
+        for (int i=0; i<profileCount; ++i) {
+            const QString name = QString("profile_%1").arg(i);
+
+            profiles.insert(name, QByteArray(profileSize, static_cast<char>(i)));
+            profileNames.append(name);
+        }
+
+        if (!PWTS::packData<QHash<QString, QByteArray>>(profiles, profilesData))
+            qFatal("failed to pack profiles");
+
+        return {
+            makeFrame("APPLY_TIMER", {static_cast<int>(PWTS::DCMD::APPLY_TIMER), packErrors(errors)}),
+            makeFrame("BATTERY_STATUS_CHANGED", {static_cast<int>(PWTS::DCMD::BATTERY_STATUS_CHANGED), packErrors(errors), QStringLiteral("battery")}),
+            makeFrame("APPLY_PROFILE", {static_cast<int>(PWTS::DCMD::APPLY_PROFILE), packErrors({}), QStringLiteral("profile_0")}),
+            makeFrame("DELETE_PROFILE", {static_cast<int>(PWTS::DCMD::DELETE_PROFILE), true}),
+            makeFrame("GET_PROFILE_LIST", {static_cast<int>(PWTS::DCMD::GET_PROFILE_LIST), QVariant::fromValue(profileNames)}),
+            makeFrame("GET_DAEMON_SETTS", {static_cast<int>(PWTS::DCMD::GET_DAEMON_SETTS), QByteArray(4096, 'x')}),
+            makeFrame("GET_DEVICE_INFO_PACKET", {static_cast<int>(PWTS::DCMD::GET_DEVICE_INFO_PACKET), QVariant::fromValue(PWTS::DeviceInfoPacket())}),
+            makeFrame("GET_DAEMON_PACKET", {static_cast<int>(PWTS::DCMD::GET_DAEMON_PACKET), QVariant::fromValue(PWTS::DaemonPacket())}),
+            makeFrame("EXPORT_PROFILES", {static_cast<int>(PWTS::DCMD::EXPORT_PROFILES), profilesData})
+        };
+    }
+
+    [[nodiscard]] bool writeCorpus(const QList<BenchFrame> &frames, const QString &path) {
+        if (!QDir().mkpath(path))
+            return false;
+
+        for (const BenchFrame &frame: frames) {
+            QFile file {QString("%1/%2.bin").arg(path, frame.label.toLower())};
+
+            if (!file.open(QIODevice::WriteOnly) || file.write(frame.data) != frame.data.size())
+                return false;
+        }
+
+        return true;
+    }
+
+    void runBench(const BenchFrame &frame, const int iterations, QTextStream &out) {
+        PWTCS::DaemonFramePool pool;
+        QDataStream ds {frame.data};
+        QElapsedTimer timer;
+        const qint64 allocsBefore = getHeapAllocCount();
+
+        timer.start();
+
+        for (int i=0; i<iterations; ++i) {
+            PWTCS::DaemonFrame *daemonFrame = pool.acquire();
+
+            ds.device()->seek(0);
+
+            if (!PWTCS::FrameDecoder::readFrame(ds, daemonFrame->args))
+                qFatal("failed to read frame %s", qPrintable(frame.label));
+
+            PWTCS::FrameDecoder::decode(*daemonFrame);
+            pool.release(daemonFrame);
+        }
+
+        const qint64 ns = qMax<qint64>(1, timer.nsecsElapsed());
+        const qint64 allocsAfter = getHeapAllocCount();
+        const double secs = static_cast<double>(ns) / 1e9;
+        const PWTCS::FrameAllocStats stats = pool.getStats();
+        const QString heapAllocsPerFrame = allocsBefore < 0 ? QStringLiteral("n/a") :
+                                                QString::number(static_cast<double>(allocsAfter - allocsBefore) / iterations, 'f', 1);
+
+        out << qSetFieldWidth(24) << Qt::left << frame.label << qSetFieldWidth(0)
+            << QString::asprintf("%10lld B %12.0f frames/s %10.2f MB/s %8.0f ns/frame %8s heap allocs/frame   pool misses %llu reused %llu args grow %llu",
+                static_cast<long long>(frame.data.size()),
+                iterations / secs,
+                (static_cast<double>(frame.data.size()) * iterations) / secs / 1e6,
+                static_cast<double>(ns) / iterations,
+                qPrintable(heapAllocsPerFrame),
+                stats.framesAllocated, stats.framesReused, stats.argsGrowths)
+            << Qt::endl;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app {argc, argv};
+    QCommandLineParser parser;
+    QTextStream out {stdout};
+    const QCommandLineOption iterationsOpt {"iterations", "Decode iterations per frame.", "n", "20000"};
+    const QCommandLineOption profilesOpt {"profiles", "Number of profiles in the export frame.", "n", "64"};
+    const QCommandLineOption profileSizeOpt {"profile-size", "Size in bytes of each exported profile.", "bytes", "8192"};
+    const QCommandLineOption corpusOpt {"write-corpus", "Write the benchmark frames as fuzzer seeds to dir and exit.", "dir"};
+
+    parser.setApplicationDescription("PWTClientService frame decode throughput benchmark");
+    parser.addHelpOption();
+    parser.addOptions({iterationsOpt, profilesOpt, profileSizeOpt, corpusOpt});
+    parser.process(app);
+
+    PWTCS::FrameDecoder::registerTypes();
+
+    const QList<BenchFrame> frames = makeFrames(parser.value(profilesOpt).toInt(), parser.value(profileSizeOpt).toInt());
+
+    if (parser.isSet(corpusOpt)) {
+        if (!writeCorpus(frames, parser.value(corpusOpt))) {
+            out << "failed to write corpus" << Qt::endl;
+            return 1;
+        }
+
+        return 0;
+    }
+
+    const int iterations = qMax(1, parser.value(iterationsOpt).toInt());
+
+    for (const BenchFrame &frame: frames)
+        runBench(frame, iterations, out);
+
+    return 0;
+}
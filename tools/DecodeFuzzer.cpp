@@ -0,0 +1,39 @@
+/*
+ * This file is part of PWTClientService.
+ * Copyright (C) 2025 kylon
+ *
+ * PWTClientService is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PWTClientService is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <QCoreApplication>
+
+#include "pwtClientService/FrameDecoder.h"
+
+extern "C" int LLVMFuzzerInitialize(int *argc, char ***argv) {
+    static QCoreApplication app {*argc, *argv};
+
+    PWTCS::FrameDecoder::registerTypes();
+    return 0;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, const size_t size) {
+    QDataStream ds {QByteArray::fromRawData(reinterpret_cast<const char *>(data), static_cast<qsizetype>(size))};
+    PWTCS::DaemonFrame frame;
+
+    while (PWTCS::FrameDecoder::readFrame(ds, frame.args) && !frame.args.isEmpty()) {
+        PWTCS::FrameDecoder::decode(frame);
+        frame.reset();
+    }
+
+    return 0;
+}
@@ -0,0 +1,161 @@
+/*
+ * This file is part of PWTClientService.
+ * Copyright (C) 2025 kylon
+ *
+ * PWTClientService is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * PWTClientService is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QTimer>
+#include <QFile>
+#include <QMap>
+#include <QDir>
+
+#include "pwtClientService/ServiceWorker.h"
+
+namespace {
+    struct CmdTiming final {
+        quint64 count = 0;
+        qint64 totalNs = 0;
+        qint64 minNs = std::numeric_limits<qint64>::max();
+        qint64 maxNs = 0;
+    };
+
+    void printReport(const QMap<int, CmdTiming> &timings, const qint64 wallNs, const int outbound, QTextStream &out) {
+        out << QString::asprintf("%6s %10s %12s %12s %12s", "cmd", "count", "min us", "avg us", "max us") << Qt::endl;
+
+        for (const auto &[cmd, timing]: timings.asKeyValueRange()) {
+            out << QString::asprintf("%6d %10llu %12.1f %12.1f %12.1f",
+                cmd,
+                timing.count,
+                static_cast<double>(timing.minNs) / 1e3,
+                static_cast<double>(timing.totalNs) / timing.count / 1e3,
+                static_cast<double>(timing.maxNs) / 1e3) << Qt::endl;
+        }
+
+        out << QString::asprintf("outbound frames: %d, wall time: %.3f ms", outbound, static_cast<double>(wallNs) / 1e6) << Qt::endl;
+    }
+
+    [[nodiscard]] bool writeCorpus(const QList<PWTCS::SessionLogRecord> &inbound, const QString &path) {
+        if (!QDir().mkpath(path))
+            return false;
+
+        for (qsizetype i=0; i<inbound.size(); ++i) {
+            const QByteArray &frame = inbound[i].frame;
+            QFile file {QString("%1/frame_%2.bin").arg(path).arg(i)};
+
+            if (!file.open(QIODevice::WriteOnly) || file.write(frame) != frame.size())
+                return false;
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app {argc, argv};
+    QCommandLineParser parser;
+    QTextStream out {stdout};
+    const QCommandLineOption recordedSpeedOpt {"recorded-speed", "Feed inbound frames at their recorded timestamps instead of maximum speed."};
+    const QCommandLineOption corpusOpt {"write-corpus", "Write the inbound frames as fuzzer seeds to dir and exit.", "dir"};
+    PWTCS::PushEventQueue pushEvents;
+    PWTCS::ServiceWorker worker {&pushEvents};
+    QList<PWTCS::SessionLogRecord> inbound;
+    QMap<int, CmdTiming> timings;
+    PWTCS::SessionLogReader reader;
+    PWTCS::SessionLogRecord record;
+    QElapsedTimer wallTimer;
+    qsizetype fed = 0;
+    int outbound = 0;
+
+    parser.setApplicationDescription("Replay a PWTClientService session capture through the frame decode path");
+    parser.addHelpOption();
+    parser.addOptions({recordedSpeedOpt, corpusOpt});
+    parser.addPositionalArgument("capture", "Session capture file.");
+    parser.process(app);
+
+    if (parser.positionalArguments().isEmpty())
+        parser.showHelp(1);
+
+    if (!reader.open(parser.positionalArguments().first())) {
+        out << "failed to open capture file" << Qt::endl;
+        return 1;
+    }
+
+    while (reader.next(record)) {
+        if (record.direction == PWTCS::SessionLogDirection::Inbound)
+            inbound.append(record);
+        else
+            ++outbound;
+    }
+
+    if (inbound.isEmpty()) {
+        out << "no inbound frames in capture" << Qt::endl;
+        return 1;
+    }
+
+    if (parser.isSet(corpusOpt)) {
+        if (!writeCorpus(inbound, parser.value(corpusOpt))) {
+            out << "failed to write corpus" << Qt::endl;
+            return 1;
+        }
+
+        return 0;
+    }
+
+    worker.init();
+
+    const auto feed = [&](const QByteArray &frame) {
+        worker.replayInbound(frame);
+        ++fed;
+    };
+
+    QObject::connect(&worker, &PWTCS::ServiceWorker::frameProcessed, [&](const PWTS::DCMD cmd, const qint64 elapsedNs) {
+        CmdTiming &timing = timings[static_cast<int>(cmd)];
+
+        ++timing.count;
+        timing.totalNs += elapsedNs;
+        timing.minNs = qMin(timing.minNs, elapsedNs);
+        timing.maxNs = qMax(timing.maxNs, elapsedNs);
+    });
+
+    // everything fed so far was read and dispatched
+    QObject::connect(&worker, &PWTCS::ServiceWorker::inboundProcessed, [&] {
+        if (fed == inbound.size())
+            app.quit();
+    });
+
+    wallTimer.start();
+
+    if (parser.isSet(recordedSpeedOpt)) {
+        const qint64 startNs = inbound.first().timestampNs;
+
+        for (const PWTCS::SessionLogRecord &rec: std::as_const(inbound)) {
+            const int delayMs = static_cast<int>((rec.timestampNs - startNs) / 1000000);
+
+            QTimer::singleShot(delayMs, Qt::PreciseTimer, &worker, [&feed, frame = rec.frame] { feed(frame); });
+        }
+
+    } else {
+        for (const PWTCS::SessionLogRecord &rec: std::as_const(inbound))
+            feed(rec.frame);
+    }
+
+    app.exec();
+
+    printReport(timings, wallTimer.nsecsElapsed(), outbound, out);
+    return 0;
+}